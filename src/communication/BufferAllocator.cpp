@@ -0,0 +1,172 @@
+/**
+ * Copyright (c) 2020 University of Luxembourg. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF LUXEMBOURG AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE UNIVERSITY OF LUXEMBOURG OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+/*
+ * BufferAllocator.cpp
+ */
+
+#include "BufferAllocator.hpp"
+#include "Window.hpp"
+
+#include <cstdlib> // posix_memalign
+#include <cstring>
+#include <cstdint>
+#include <sstream>
+#include <sys/mman.h>
+
+using namespace std;
+
+vector<pair<char*, size_t>> BufferAllocator::pool;
+
+pthread_mutex_t BufferAllocator::pool_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+char* BufferAllocator::allocate(size_t capacity, size_t& allocated) {
+
+	// round the capacity so that the end of the buffer is aligned as well
+	capacity = (capacity + BUFFER_ALIGNMENT - 1) / BUFFER_ALIGNMENT * BUFFER_ALIGNMENT;
+
+	if (BUFFER_HUGE_PAGES != HUGE_PAGES_NONE && capacity >= HUGE_PAGE_MIN_CAPACITY) {
+		allocated = mappedLength(capacity);
+
+		pthread_mutex_lock(&pool_mtx);
+		for (size_t i = 0; i < pool.size(); i++) {
+			if (pool[i].second == allocated) {
+				char* buffer = pool[i].first;
+				pool[i] = pool.back();
+				pool.pop_back();
+				pthread_mutex_unlock(&pool_mtx);
+				return buffer;
+			}
+		}
+		pthread_mutex_unlock(&pool_mtx);
+
+		return map(allocated);
+	}
+
+	void* buffer = nullptr;
+	if (posix_memalign(&buffer, BUFFER_ALIGNMENT, capacity > 0 ? capacity : BUFFER_ALIGNMENT) != 0) {
+		throw bad_alloc();
+	}
+
+	allocated = 0;
+	return static_cast<char*>(buffer);
+}
+
+void BufferAllocator::release(char* buffer, size_t allocated) {
+	if (buffer == nullptr) {
+		return;
+	}
+
+	if (allocated == 0) {
+		free(buffer);
+		return;
+	}
+
+	pthread_mutex_lock(&pool_mtx);
+	if (pool.size() < BUFFER_POOL_SIZE) {
+		pool.push_back(make_pair(buffer, allocated));
+		buffer = nullptr;
+	}
+	pthread_mutex_unlock(&pool_mtx);
+
+	if (buffer != nullptr) {
+		munmap(buffer, allocated);
+	}
+}
+
+void BufferAllocator::reserve(size_t nof_buffers, size_t capacity) {
+	if (BUFFER_HUGE_PAGES == HUGE_PAGES_NONE || capacity < HUGE_PAGE_MIN_CAPACITY) {
+		return;
+	}
+
+	const size_t length = mappedLength(capacity);
+
+	for (size_t i = 0; i < nof_buffers; i++) {
+		char* buffer = map(length);
+
+		// touch every page so that they are faulted now rather than
+		// when the first messages arrive
+		for (size_t offset = 0; offset < length; offset += 4096) {
+			buffer[offset] = 0;
+		}
+
+		release(buffer, length);
+	}
+}
+
+size_t BufferAllocator::mappedLength(size_t capacity) {
+	return (capacity + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+}
+
+/**
+ * Maps length bytes (a multiple of HUGE_PAGE_SIZE) aligned on a huge page.
+ * 
+ * Explicit huge pages come from the pool reserved by the system 
+ * (vm.nr_hugepages), if there are none left we fall back on transparent
+ * huge pages.
+ * */
+char* BufferAllocator::map(size_t length) {
+	const int prefault = BUFFER_PREFAULT ? MAP_POPULATE : 0;
+
+	if (BUFFER_HUGE_PAGES == HUGE_PAGES_EXPLICIT) {
+		void* buffer = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | prefault, -1, 0);
+
+		if (buffer != MAP_FAILED) {
+			return static_cast<char*>(buffer);
+		}
+	}
+
+	// over-allocate to be able to align the buffer on a huge page,
+	// then give the unused head and tail back to the system
+	void* region = mmap(nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if (region == MAP_FAILED) {
+		throw bad_alloc();
+	}
+
+	const uintptr_t start = reinterpret_cast<uintptr_t>(region);
+	const uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+
+	if (aligned > start) {
+		munmap(region, aligned - start);
+	}
+	if (aligned + length < start + length + HUGE_PAGE_SIZE) {
+		munmap(reinterpret_cast<void*>(aligned + length), start + HUGE_PAGE_SIZE - aligned);
+	}
+
+	char* buffer = reinterpret_cast<char*>(aligned);
+	madvise(buffer, length, MADV_HUGEPAGE);
+
+	if (BUFFER_PREFAULT) {
+		for (size_t offset = 0; offset < length; offset += 4096) {
+			buffer[offset] = 0;
+		}
+	}
+
+	return buffer;
+}
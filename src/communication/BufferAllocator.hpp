@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) 2020 University of Luxembourg. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF LUXEMBOURG AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE UNIVERSITY OF LUXEMBOURG OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+/*
+ * BufferAllocator.hpp
+ */
+
+#ifndef COMMUNICATION_BUFFERALLOCATOR_HPP_
+#define COMMUNICATION_BUFFERALLOCATOR_HPP_
+
+#include <cstddef>
+#include <vector>
+#include <pthread.h>
+
+/**
+ * Allocates the binary buffers of the windows and messages.
+ * 
+ * Every buffer is aligned on BUFFER_ALIGNMENT bytes. Depending on the
+ * BUFFER_HUGE_PAGES setting (Window.hpp), buffers of at least 
+ * HUGE_PAGE_MIN_CAPACITY bytes are mapped on (transparent or explicit)
+ * huge pages, which avoids a TLB miss every 4KB when reading big messages.
+ * Released huge buffers are kept in a pool (up to BUFFER_POOL_SIZE) and
+ * reused, as mapping and faulting them is expensive.
+ * */
+class BufferAllocator {
+
+public:
+
+	// returns a buffer of at least capacity bytes, allocated is set to
+	// the mapped length, or 0 if the buffer comes from the heap
+	static char* allocate(size_t capacity, size_t& allocated);
+
+	static void release(char* buffer, size_t allocated);
+
+	// maps and pre-faults nof_buffers huge buffers in the pool, so that
+	// the first messages don't pay for it (does nothing without huge pages)
+	static void reserve(size_t nof_buffers, size_t capacity);
+
+private:
+
+	static char* map(size_t length);
+
+	static size_t mappedLength(size_t capacity);
+
+	static std::vector<std::pair<char*, size_t>> pool;
+
+	static pthread_mutex_t pool_mtx;
+};
+
+#endif /* COMMUNICATION_BUFFERALLOCATOR_HPP_ */
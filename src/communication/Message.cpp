@@ -32,6 +32,7 @@
  */
 
 #include "Message.hpp"
+#include "MessageHeader.hpp"
 
 using namespace std;
 
@@ -46,7 +47,7 @@ Message::Message(int capacity) :
 }
 
 Message::Message(int capacity, int wrapper_length) :
-		Window(capacity + sizeof(int) + wrapper_length * sizeof(WrapperUnit)) {
+		Window(capacity + MessageHeader::length(wrapper_length)) {
 	this->wrapper_length = wrapper_length;
 }
 
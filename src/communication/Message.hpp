@@ -44,7 +44,8 @@ typedef struct WrapperUnit {
 	int completeness_tag_denominator;
 } WrapperUnit;
 
-// container for incoming and outgoing messages, may optionally contain wrapper information as header
+// container for incoming and outgoing messages, may optionally contain a header
+// with wrapper information (see MessageHeader.hpp)
 class Message: public Window {
 
 public:
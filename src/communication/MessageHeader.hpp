@@ -0,0 +1,204 @@
+/**
+ * Copyright (c) 2020 University of Luxembourg. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF LUXEMBOURG AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE UNIVERSITY OF LUXEMBOURG OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+/*
+ * MessageHeader.hpp
+ */
+
+#ifndef COMMUNICATION_MESSAGEHEADER_HPP_
+#define COMMUNICATION_MESSAGEHEADER_HPP_
+
+#include "Message.hpp"
+#include "Window.hpp" // BUFFER_ALIGNMENT
+
+#include <cstdint>
+#include <climits> // LONG_MIN
+#include <cstring> // memcpy
+#include <sstream>
+
+/**
+ * Fixed-layout header written at the front of every message buffer.
+ * 
+ * Routing, ordering and completeness information are always found at
+ * the same place, so that an operator can read them without looking at
+ * the message body. The header is followed by nof_wrapper_units wrapper
+ * units, then by the message body (see payloadOffset).
+ * 
+ * The buffer of a message is aligned on BUFFER_ALIGNMENT bytes, so the
+ * header is suitably aligned and reading it takes a single cache line.
+ * The wrapper units are padded so that the body starts on an aligned
+ * offset as well.
+ * 
+ * Fields that are not used by an operator are left to their default
+ * value (-1 for the identifiers, NO_WATERMARK for the watermark).
+ * */
+
+// watermark of the messages that carry no progress information
+static const long int NO_WATERMARK = LONG_MIN;
+
+// bits of MessageHeader::flags, a result message may carry several of them
+static const uint8_t WINDOW_DELTA = 1 << 0; // result of late events only, to merge with the earlier results of its window
+static const uint8_t EARLY_RESULT = 1 << 1; // result of a window that is not complete yet
+
+typedef struct alignas(8) MessageHeader {
+
+	static const uint16_t VERSION = 2; // increase when modifying the layout
+
+	uint16_t version;
+	char baseline; // d default, c count, w flow-wrapping, s sort, e event-time watermarks
+	uint8_t flags; // WINDOW_DELTA, EARLY_RESULT
+	int nof_wrapper_units;
+	int message_id;
+	int window_id;
+	int min_wid; // smallest window id found in the original message
+	int max_wid; // biggest window id found in the original message
+	long int timestamp;
+	long int watermark; // no event older than the watermark follows on the same channel
+
+	MessageHeader();
+
+	size_t payloadOffset() const;
+
+	static size_t length(const int nof_wrapper_units);
+
+	static size_t unitOffset(const int index);
+
+	static MessageHeader read(const Message*const message);
+
+	static const MessageHeader& peek(const Message*const message);
+
+	static void write(const MessageHeader& header, Message*const message);
+
+	static WrapperUnit readWrapperUnit(const Message*const message, const int index);
+
+	static void writeWrapperUnit(const WrapperUnit& unit, const int index, Message*const message);
+
+} MessageHeader;
+
+static_assert(sizeof(MessageHeader) == 40, "MessageHeader layout changed, update MessageHeader::VERSION");
+
+inline MessageHeader::MessageHeader() :
+version(VERSION),
+baseline('d'),
+flags(0),
+nof_wrapper_units(0),
+message_id(-1),
+window_id(-1),
+min_wid(-1),
+max_wid(-1),
+timestamp(0),
+watermark(NO_WATERMARK) {}
+
+/**
+ * Number of bytes preceding the message body.
+ * */
+inline size_t MessageHeader::payloadOffset() const {
+	return length(nof_wrapper_units);
+}
+
+/**
+ * Number of bytes taken by a header followed by the given number of wrapper
+ * units, rounded up to BUFFER_ALIGNMENT so that the body is aligned.
+ * */
+inline size_t MessageHeader::length(const int nof_wrapper_units) {
+	const size_t length = unitOffset(nof_wrapper_units);
+	return (length + BUFFER_ALIGNMENT - 1) / BUFFER_ALIGNMENT * BUFFER_ALIGNMENT;
+}
+
+/**
+ * Offset of the wrapper unit at the given index, the units are packed right after the header.
+ * */
+inline size_t MessageHeader::unitOffset(const int index) {
+	return sizeof(MessageHeader) + index * sizeof(WrapperUnit);
+}
+
+/**
+ * Returns a reference to the header of the message, without copying it.
+ * Throws if the message is too small or if the header has another version.
+ * */
+inline const MessageHeader& MessageHeader::peek(const Message*const message) {
+	if (message->size < (int) sizeof(MessageHeader)) {
+		std::stringstream ss;
+		ss << "[MessageHeader](peek) Message size is too small : " << message->size;
+		throw ss.str();
+	}
+
+	const MessageHeader& header = *reinterpret_cast<const MessageHeader*>(message->buffer);
+
+	if (header.version != VERSION) {
+		std::stringstream ss;
+		ss << "[MessageHeader](peek) Unknown header version : " << header.version
+		<< " (expected " << VERSION << ")";
+		throw ss.str();
+	}
+
+	return header;
+}
+
+/**
+ * Returns a copy of the header of the message.
+ * */
+inline MessageHeader MessageHeader::read(const Message*const message) {
+	return peek(message);
+}
+
+/**
+ * Writes the header at the front of the message buffer. The message size
+ * is not modified, the caller is expected to have reserved the space.
+ * */
+inline void MessageHeader::write(const MessageHeader& header, Message*const message) {
+	if (message->capacity < (int) sizeof(MessageHeader)) {
+		std::stringstream ss;
+		ss << "[MessageHeader](write) Message capacity is too small : " << message->capacity;
+		throw ss.str();
+	}
+
+	memcpy(message->buffer, &header, sizeof(MessageHeader));
+}
+
+inline WrapperUnit MessageHeader::readWrapperUnit(const Message*const message, const int index) {
+	if (message->size < (int) unitOffset(index + 1)) {
+		std::stringstream ss;
+		ss << "[MessageHeader](readWrapperUnit) No wrapper unit at index " << index;
+		throw ss.str();
+	}
+
+	WrapperUnit unit;
+	memcpy(&unit, message->buffer + unitOffset(index), sizeof(WrapperUnit));
+	return unit;
+}
+
+inline void MessageHeader::writeWrapperUnit(const WrapperUnit& unit, const int index, Message*const message) {
+	if (message->capacity < (int) unitOffset(index + 1)) {
+		std::stringstream ss;
+		ss << "[MessageHeader](writeWrapperUnit) Message capacity is too small for index " << index;
+		throw ss.str();
+	}
+
+	memcpy(message->buffer + unitOffset(index), &unit, sizeof(WrapperUnit));
+}
+
+#endif /* COMMUNICATION_MESSAGEHEADER_HPP_ */
@@ -32,6 +32,7 @@
  */
 
 #include "Window.hpp"
+#include "BufferAllocator.hpp"
 
 #include <iostream>
 
@@ -39,20 +40,19 @@ using namespace std;
 
 Window::Window() {
 	this->buffer = nullptr;
+	this->mapped = 0;
 	this->capacity = 0;
 	this->size = 0;
 }
 
 Window::Window(int capacity) {
-	this->buffer = new char[capacity];
+	this->buffer = BufferAllocator::allocate(capacity, this->mapped);
 	this->capacity = capacity;
 	this->size = 0;
 }
 
 Window::~Window() {
-	if (this->buffer != nullptr)
-		delete[] this->buffer;
-
+	BufferAllocator::release(this->buffer, this->mapped);
 }
 
 void Window::clear() {
@@ -60,9 +60,8 @@ void Window::clear() {
 }
 
 void Window::resize(int capacity) {
-	if (this->buffer != nullptr)
-		delete[] this->buffer;
-	this->buffer = new char[capacity];
+	BufferAllocator::release(this->buffer, this->mapped);
+	this->buffer = BufferAllocator::allocate(capacity, this->mapped);
 	this->capacity = capacity;
 	this->size = 0;
 
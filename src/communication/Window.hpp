@@ -42,7 +42,9 @@ static const int PER_SEC_MSG_COUNT = 2;
 
 static const int EVENT_SIZE = 136; //bytes
 
-static const int MAX_WRAPPER_SIZE = 1;
+// max. number of wrapper units in a message, i.e. number of windows
+// a single message may span
+static const int MAX_WRAPPER_SIZE = 64;
 
 // deprecated
 static const long WINDOW_SIZE = (THROUGHPUT / PER_SEC_MSG_COUNT) * EVENT_SIZE
@@ -54,6 +56,32 @@ static const size_t DEFAULT_WINDOW_SIZE = 1000000; // 1MB
 
 static const long AGG_WIND_SPAN = 10000; //MSEC
 
+// event time covered by a generated message, messages that cross a window
+// boundary carry one wrapper unit per window (at most MAX_WRAPPER_SIZE)
+static const long MSG_TIME_SPAN = 1000; //MSEC
+
+// window buffers are aligned on a cache line, which also allows aligned
+// vector loads on the payload (see MessageHeader::length)
+static const size_t BUFFER_ALIGNMENT = 64;
+
+enum HugePages { HUGE_PAGES_NONE, HUGE_PAGES_TRANSPARENT, HUGE_PAGES_EXPLICIT };
+
+// explicit huge pages need vm.nr_hugepages to be set on every node,
+// buffers silently fall back on transparent huge pages otherwise
+static const HugePages BUFFER_HUGE_PAGES = HUGE_PAGES_NONE;
+
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024; // 2MB
+
+// smaller buffers are always allocated on the heap
+static const size_t HUGE_PAGE_MIN_CAPACITY = DEFAULT_WINDOW_SIZE;
+
+// number of released huge buffers kept for reuse
+static const size_t BUFFER_POOL_SIZE = 64;
+
+// fault the huge buffers when they are mapped (and fill the pool at
+// startup) instead of on the first write
+static const bool BUFFER_PREFAULT = false;
+
 // raw container for windowed stream data
 class Window {
 
@@ -65,6 +93,8 @@ public:
 
 	int capacity; // size available of the binary buffer
 
+	size_t mapped; // length mapped for the buffer, 0 if on the heap (see BufferAllocator)
+
 	Window();
 
 	Window(int capacity);
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+#include <cstddef> // size_t
+
+/**
+ * Accumulators hold the state of a window in the aggregators, they
+ * are updated as soon as the events of a message arrive, so that a
+ * complete window only has to read its result :
+ *
+ *     A accumulator;                  // init
+ *     accumulator.add(event);         // for every event of the window
+ *     accumulator.merge(other);       // adds the events of another accumulator
+ *     accumulator.result();           // value of the aggregate function
+ *     accumulator.size();             // number of events added
+ *
+ * An accumulator may also define retract(event), the inverse of add,
+ * for windows that can forget events.
+ * */
+
+/**
+ * Keeps every event, for the functions that need all the events of a
+ * window at once (e.g. a median). This is what the aggregators store
+ * by default.
+ * */
+template<typename T>
+class BufferAccumulator {
+
+    public:
+        void add(const T& event){
+            events.push_back(event); // copy
+        }
+
+        void merge(const BufferAccumulator<T>& other){
+            events.insert(events.end(), other.events.begin(), other.events.end());
+        }
+
+        const std::vector<T>& result() const {
+            return events;
+        }
+
+        size_t size() const {
+            return events.size();
+        }
+
+    private:
+        std::vector<T> events;
+};
+
+/**
+ * Counts the events of a window in constant memory.
+ * */
+template<typename T>
+class CountAccumulator {
+
+    public:
+        void add(const T&){
+            count++;
+        }
+
+        void retract(const T&){
+            count--;
+        }
+
+        void merge(const CountAccumulator<T>& other){
+            count += other.count;
+        }
+
+        size_t result() const {
+            return count;
+        }
+
+        size_t size() const {
+            return count;
+        }
+
+    private:
+        size_t count = 0;
+};
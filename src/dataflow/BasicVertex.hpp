@@ -1,18 +1,16 @@
 #pragma once
 #include "Vertex.hpp"
+#include "OutputBuilder.hpp" // message_ptr, destination, output_data
+#include "../communication/MessageHeader.hpp"
 #include <vector>
+#include <map>
 #include <memory> // make_unique
 #include <sstream>
 
-// these unique_ptr will make sure the ownership of the 
-// message objects is correctly transferred
 using std::move;
 using std::make_unique;
 using std::pair;
 using std::cout;
-using message_ptr = unique_ptr<Message>;
-using destination = vector<int>;
-using output_data = pair<message_ptr, destination>;
 
 /**
  * BasicVertex adds the functionnalities to easily define 
@@ -26,6 +24,22 @@ using output_data = pair<message_ptr, destination>;
  * events - such as generator implementation - then it is
  * enough to just leave the default template parameter.
  * 
+ * Operators producing records should prefer the builder version of
+ * processEvent: records are appended to one message per destination
+ * and the header is written once per output message when the builder
+ * is flushed. Operators overriding the older processEvent (returning
+ * one message per output) keep working, their messages are appended
+ * to the builder by the default implementation.
+ * 
+ * Messages start with a MessageHeader (message id, baseline, window ids,
+ * wrapper units...) followed by the events. Use createMessage to get a
+ * message whose header space is already reserved, and writeHeader once
+ * the message is complete.
+ * 
+ * The vertex keeps the last watermark received on each input channel,
+ * and writeHeader forwards their minimum (see getWatermark), so that the
+ * watermarks emitted by the sources flow through the whole dataflow.
+ * 
  * Note when manipulating the message pointers (unique_ptr):
  * - don't forget to use std::move instead of copy when
  *  using =, push_back, a.s.o.
@@ -41,18 +55,26 @@ class BasicVertex : public Vertex {
 
     protected:
         virtual vector<output_data> processEvent(const Event& event);
+        virtual void processEvent(const Event& event, OutputBuilder& out);
         virtual vector<output_data> processMessage(message_ptr message);
-        virtual message_ptr fetchNextMessage(int channel, list<message_ptr>& pthread_waiting_list);
+        virtual vector<output_data> flushOutputs(OutputBuilder& out, int message_id);
+        virtual message_ptr fetchNextMessage(int channel);
         virtual void send(vector<output_data> messages);
         void increaseHeaderSize(unsigned int increment);
         void setBaseline(char c);
         unsigned int getHeaderSize();
         message_ptr createMessage(size_t size);
+        OutputBuilder createOutputBuilder(size_t initial_capacity = 0);
+        MessageHeader readHeader(const message_ptr& message);
+        void writeHeader(Message*const message, int message_id, int window_id = -1);
         int readMessageID(const message_ptr& message);
         char readBaseline(const message_ptr& message);
         char getBaseline();
+        void updateWatermark(int channel, long int watermark);
+        long int getWatermark();
         vector<Event> readEvents(const message_ptr& message);
         vector<message_ptr> fetchMessages(int channel);
+        list<message_ptr>& getWaitingList(const int channel);
 
         pthread_mutex_t cout_mtx;
         destination target_all_ranks;
@@ -60,8 +82,12 @@ class BasicVertex : public Vertex {
         destination target_other_ranks;
 
     private:
-        unsigned int header_size = sizeof(int) + sizeof(char); // message id then aggregation protocol (baseline)
-        char baseline = 'd'; // d default, c count, w flow-wrapping, s sort
+        unsigned int header_size = MessageHeader::length(0); // front header, increased when wrapper units are reserved
+        char baseline = 'd'; // d default, c count, w flow-wrapping, s sort, e event-time watermarks
+        vector<long int> input_watermarks; // last watermark of each input channel
+        pthread_mutex_t watermark_mtx;
+        map<int, list<message_ptr>> waiting_lists; // messages fetched but not processed yet, one list per channel
+        pthread_mutex_t waiting_mtx;
 };
 
 #include <numeric>
@@ -74,14 +100,16 @@ class BasicVertex : public Vertex {
 template<typename Event>
 BasicVertex<Event>::BasicVertex(const int tag, const int rank, const int worldSize) : 
 Vertex(tag, rank, worldSize),
-target_other_ranks(vector<int>()),
+target_all_ranks(vector<int>(worldSize)),
 target_same_rank(vector<int>({rank})),
-target_all_ranks(vector<int>(worldSize)) {
+target_other_ranks(vector<int>()) {
     // fill targetRanks with all possible ranks {0, 1, ... worldSize - 1}
     std::iota(target_all_ranks.begin(), target_all_ranks.end(), 0);
 
     // initialize mutexes
     pthread_mutex_init(&cout_mtx, NULL);
+    pthread_mutex_init(&watermark_mtx, NULL);
+    pthread_mutex_init(&waiting_mtx, NULL);
 }
 
 /**
@@ -108,11 +136,9 @@ target_all_ranks(vector<int>(worldSize)) {
 template<typename Event>
 void BasicVertex<Event>::streamProcess(int channel){
 
-    // stores incoming messages
-    list<message_ptr> pthread_waiting_list;
-
     while (ALIVE) {
-        message_ptr message = fetchNextMessage(channel, pthread_waiting_list);
+        message_ptr message = fetchNextMessage(channel);
+        updateWatermark(channel, MessageHeader::peek(message.get()).watermark);
         vector<output_data> out = processMessage(move(message));
         send(move(out));
     }
@@ -125,7 +151,8 @@ void BasicVertex<Event>::streamProcess(int channel){
  * decorating this method.
  * */
 template<typename Event>
-message_ptr BasicVertex<Event>::fetchNextMessage(int channel, list<message_ptr>& pthread_waiting_list){
+message_ptr BasicVertex<Event>::fetchNextMessage(int channel){
+    list<message_ptr>& pthread_waiting_list = getWaitingList(channel);
 
     // if there is no message in the waiting list
     // then wait for new messages to arrive
@@ -172,16 +199,31 @@ vector<message_ptr> BasicVertex<Event>::fetchMessages(int channel){
     return move(res);
 }
 
+/**
+ * Each channel is read by a single thread, which is the only
+ * one using the waiting list of the channel.
+ * */
+template<typename Event>
+list<message_ptr>& BasicVertex<Event>::getWaitingList(const int channel){
+    pthread_mutex_lock(&waiting_mtx);
+    list<message_ptr>& waiting_list = waiting_lists[channel]; // references to map elements stay valid
+    pthread_mutex_unlock(&waiting_mtx);
+
+    return waiting_list;
+}
+
 /**
  * Reads events one by one and calls a user-defined method to process each event.
  * This effectively moves the user focus from managing messages to processing events.
+ * 
+ * All the records produced for this input are gathered in one message per
+ * destination rank, whose header is written once when the builder is flushed.
  * */
 template<typename Event>
 vector<output_data> BasicVertex<Event>::processMessage(message_ptr message){
-    vector<output_data> out;
-
-    int message_id = readMessageID(message);
-    char input_baseline = readBaseline(message);
+    const MessageHeader header = readHeader(message);
+    const int message_id = header.message_id;
+    const char input_baseline = header.baseline;
 
     if(input_baseline != baseline){
         stringstream ss;
@@ -191,36 +233,61 @@ vector<output_data> BasicVertex<Event>::processMessage(message_ptr message){
         throw ss.str();
     }
 
+    // outputs are usually spread over the ranks and rarely bigger than the
+    // input, which gives a first guess for the capacity of the output messages
+    OutputBuilder builder = createOutputBuilder((message->size - header.payloadOffset()) / worldSize);
+
     vector<Event> events = readEvents(message);
     for (const Event& event : events){
-        vector<output_data> processed = move(processEvent(event));
+        processEvent(event, builder);
+    }
 
-        for (size_t i = 0; i < processed.size(); i++){
-            message_ptr message(move(processed[i].first)); // move
+    return flushOutputs(builder, message_id);
+}
 
-            // add message header
-            Serialization::wrap<char>(baseline, message.get());
-            Serialization::wrap<int>(message_id, message.get());
+/**
+ * Hands over the messages of the builder (one per destination rank) after
+ * adding their header. Subclasses batching several inputs in the same 
+ * builder can call this method whenever they want to emit their outputs.
+ * */
+template<typename Event>
+vector<output_data> BasicVertex<Event>::flushOutputs(OutputBuilder& builder, int message_id){
+    vector<output_data> out = builder.flush();
 
-            destination dest = processed[i].second;
-            output_data od = make_pair(move(message), dest);
-            out.push_back(move(od));
-        }
+    for (output_data& data : out){
+        writeHeader(data.first.get(), message_id);
     }
 
-    return move(out);
+    return out;
+}
+
+template<typename Event>
+MessageHeader BasicVertex<Event>::readHeader(const message_ptr& message){
+    return MessageHeader::read(message.get());
+}
+
+/**
+ * Writes the header of an outgoing message, with the baseline of this vertex.
+ * The header space must have been reserved (cf. createMessage).
+ * */
+template<typename Event>
+void BasicVertex<Event>::writeHeader(Message*const message, int message_id, int window_id){
+    MessageHeader header;
+    header.baseline = baseline;
+    header.message_id = message_id;
+    header.window_id = window_id;
+    header.watermark = getWatermark();
+    MessageHeader::write(header, message);
 }
 
 template<typename Event>
 int BasicVertex<Event>::readMessageID(const message_ptr& message){
-    // message header = msgid (int) + baseline (char)
-    return Serialization::read_back<int>(message.get());
+    return MessageHeader::peek(message.get()).message_id;
 }
 
 template<typename Event>
 char BasicVertex<Event>::readBaseline(const message_ptr& message){
-    // message header = msgid (int) + baseline (char)
-    return Serialization::read_back<char>(message.get(), sizeof(int)); 
+    return MessageHeader::peek(message.get()).baseline;
 }
 
 /**
@@ -228,11 +295,12 @@ char BasicVertex<Event>::readBaseline(const message_ptr& message){
  * */
 template<typename Event>
 vector<Event> BasicVertex<Event>::readEvents(const message_ptr& message){
-    const size_t nof_events = (message->size - header_size) / sizeof(Event);
+    const size_t offset = MessageHeader::peek(message.get()).payloadOffset();
+    const size_t nof_events = (message->size - offset) / sizeof(Event);
 
     vector<Event> events; events.reserve(nof_events);
     for (size_t i = 0; i < nof_events; i++){
-        Event e = Serialization::read_front<Event>(message.get(),  i * sizeof(Event));
+        Event e = Serialization::read_front<Event>(message.get(), offset + i * sizeof(Event));
         events.push_back(e); // copy for now
     }
 
@@ -271,7 +339,30 @@ vector<output_data> BasicVertex<Event>::processEvent(const Event& event){
 }
 
 /**
- * Initializes a new message with enough space for the header data
+ * Adapter between the two versions of processEvent : calls the version
+ * returning one message per output and appends the content of these
+ * messages to the builder, for each of their destinations.
+ * 
+ * Override this method instead of the other one to append records 
+ * directly to the builder, e.g. :
+ *     out.append<MyRecord>(record, target_rank);
+ * */
+template<typename Event>
+void BasicVertex<Event>::processEvent(const Event& event, OutputBuilder& out){
+    vector<output_data> processed = processEvent(event);
+
+    for (output_data& data : processed){
+        for (const int rank : data.second){
+            // skip the header space reserved by createMessage
+            out.append(data.first->buffer + header_size, data.first->size - header_size, rank);
+        }
+    }
+}
+
+/**
+ * Initializes a new message with enough space for the header data.
+ * The header space is reserved at the front of the buffer, so events
+ * can be appended right away (e.g. with Serialization::wrap).
  * 
  * Users shoudn't use the natural Message constructor as they would
  * have to take into account the size of the header data as well as 
@@ -280,7 +371,19 @@ vector<output_data> BasicVertex<Event>::processEvent(const Event& event){
  * */
 template<typename Event>
 message_ptr BasicVertex<Event>::createMessage(size_t size){
-    return unique_ptr<Message>(new Message(header_size + size));
+    message_ptr message(new Message(header_size + size));
+    message->size = header_size;
+    return message;
+}
+
+/**
+ * Initializes an empty builder whose messages will have enough space
+ * for the header. Wrapper units are not forwarded by the builder, so
+ * only the fixed part of the header is reserved.
+ * */
+template<typename Event>
+OutputBuilder BasicVertex<Event>::createOutputBuilder(size_t initial_capacity){
+    return OutputBuilder(worldSize, MessageHeader::length(0), initial_capacity);
 }
 
 /**
@@ -291,6 +394,9 @@ message_ptr BasicVertex<Event>::createMessage(size_t size){
  * You can't modify which of the following operators will be delivered
  * with a message, because this is something you have to set up in the
  * use case definition file (e.g. NQ5.hpp and NQ5.cpp)
+ * 
+ * The message itself is handed over to its last target, only the other
+ * targets receive a copy.
  * */
 template<typename Event>
 void BasicVertex<Event>::send(vector<output_data> messages){
@@ -302,11 +408,14 @@ void BasicVertex<Event>::send(vector<output_data> messages){
         } else if (data.second.size() > worldSize) {
             throw "[BasicVertex](send) Message destination rank does not exist.";
         } else {
+            size_t nof_targets = data.second.size() * next.size();
+
             for(int targetRank : data.second){
                 for(size_t targetOperator = 0; targetOperator < next.size(); targetOperator++){
                     size_t target = targetOperator * worldSize + targetRank;
 
-                    Message* cpy = Serialization::copy(data.first.get());
+                    Message* cpy = (--nof_targets == 0) ?
+                        data.first.release() : Serialization::copy(data.first.get());
 
                     pthread_mutex_lock(&senderMutexes[target]);
                     outMessages[target].push_back(cpy);
@@ -329,9 +438,9 @@ void BasicVertex<Event>::increaseHeaderSize(unsigned int increment){
 }
 
 /**
- * Returns the current value of the header size. Basic value is sizeof(int)
- * because message header contains an identifier, but it might be increased
- * to contain more data.
+ * Returns the current value of the header size. Basic value is 
+ * MessageHeader::length(0), but it might be increased to reserve space
+ * for wrapper units.
  * */
 template<typename Event>
 unsigned int BasicVertex<Event>::getHeaderSize(){
@@ -361,4 +470,43 @@ void BasicVertex<Event>::setBaseline(char c){
 template<typename Event>
 char BasicVertex<Event>::getBaseline(){
     return baseline;
-}
\ No newline at end of file
+}
+
+/**
+ * Records the watermark of a message received on the given channel.
+ * Watermarks only move forward : an older watermark (or a message without
+ * watermark) leaves the channel unchanged.
+ * */
+template<typename Event>
+void BasicVertex<Event>::updateWatermark(int channel, long int watermark){
+    pthread_mutex_lock(&watermark_mtx);
+
+    if (input_watermarks.empty()){
+        input_watermarks.resize(previous.size() * worldSize, NO_WATERMARK);
+    }
+
+    if (watermark > input_watermarks[channel]){
+        input_watermarks[channel] = watermark;
+    }
+
+    pthread_mutex_unlock(&watermark_mtx);
+}
+
+/**
+ * Low watermark of this vertex : the minimum of the watermarks of its
+ * input channels, NO_WATERMARK as long as one of the channels hasn't sent
+ * any. Note that a channel that never sends anything (e.g. a predecessor
+ * only running on some ranks) holds the watermark back forever.
+ * */
+template<typename Event>
+long int BasicVertex<Event>::getWatermark(){
+    pthread_mutex_lock(&watermark_mtx);
+
+    long int watermark = input_watermarks.empty() ? NO_WATERMARK : LONG_MAX;
+    for (const long int channel_watermark : input_watermarks){
+        watermark = std::min(watermark, channel_watermark);
+    }
+
+    pthread_mutex_unlock(&watermark_mtx);
+    return watermark;
+}
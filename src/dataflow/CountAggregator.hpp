@@ -1,7 +1,10 @@
 #pragma once
 #include "BasicVertex.hpp"
+#include "Accumulator.hpp"
+#include "WindowRing.hpp"
 
 #include <map>
+#include <set>
 #include <vector>
 #include <mpi.h>
 #include <sstream>
@@ -15,25 +18,41 @@ using std::cout;
  * Basic implementation of information necessary
  * to process a window of events.
  * */
-template<typename T>
+template<typename T, typename A = BufferAccumulator<T>>
 class WindowInformation {
         
     public:
         unsigned int completeness = 0;
-        vector<T> events;
-        pthread_mutex_t lock;
-        WindowInformation(){pthread_mutex_init(&lock, NULL);};
+        unsigned int max_completeness = 1; // only used by the flow-wrapping baseline
+        bool fired = false; // a window kept after its result can still receive late events
+        A accumulator; // events not output yet, only the late ones once the window is fired
 };
 
 /**
  * One of the three baselines for aggregation.
  * Send an output message only when enough messages
  * have been received for the oldest window.
+ *
+ * The events of a window are folded in an accumulator of type A
+ * (cf. Accumulator.hpp) as messages arrive. The default accumulator
+ * keeps all the events, for the functions that need them.
+ *
+ * Windows are stored in a ring of slots (cf. WindowRing.hpp) : the
+ * completeness and the events of a window are updated together under
+ * the lock of its slot, so channels updating different windows don't
+ * wait for each other.
+ *
+ * A window is released once it is expired (cf. isWindowExpired), by
+ * default as soon as it has been fired. Subclasses that keep windows
+ * longer fire them again on late events : the accumulator is emptied
+ * when a window is fired, so the next result only covers the late
+ * events and is flagged WINDOW_DELTA (e.g. the late events to add to
+ * the count of the window).
  * */
-template<typename T>
+template<typename T, typename A = BufferAccumulator<T>>
 class CountAggregator : public BasicVertex<T> {
 
-    using Windows = map<int, WindowInformation<T>>;
+    using Window = WindowInformation<T, A>;
 
     public:
         CountAggregator(const int tag, const int rank, const int worldSize);
@@ -42,28 +61,26 @@ class CountAggregator : public BasicVertex<T> {
     protected:    
         virtual vector<int> getWindowIDs(const T& event) = 0; // user must define what type of window we are dealing with
         virtual int getMaxCompleteness() = 0; // use must define the expected number of messages depending on the dataflow structure implemented
-        virtual vector<output_data> processWindow(const vector<T>& events); // user can define his own version
+        virtual vector<output_data> processWindow(const A& accumulator); // user can define his own version
         virtual vector<output_data> processMessage(message_ptr message); // replaces previous implementation
-        virtual bool isWindowComplete(int window_id);
-        virtual void updateCompleteness(int window_id);
-        map<int, vector<T>> shardEvents(vector<T>& events);
+        virtual bool isWindowComplete(int window_id, const Window& window);
+        virtual bool isWindowExpired(int window_id, const Window& window);
+        virtual void updateCompleteness(Window& window, const vector<WrapperUnit>& units);
+        virtual map<int, vector<WrapperUnit>> shardWrapperUnits(const message_ptr& message);
+        map<int, A> shardEvents(vector<T>& events);
+        vector<output_data> fireWindow(int window_id);
+        vector<output_data> fireWindow(int window_id, Window& window); // slot already locked
 
-
-    private:
-        void updateEvents(int window_id, vector<T>& events);
-        Windows windows;
-        pthread_mutex_t windows_mtx;
+        WindowRing<Window> windows;
 
 };
 
-template<typename T>
-CountAggregator<T>::CountAggregator(const int tag, const int rank, const int worldSize) : 
-BasicVertex<T>(tag, rank, worldSize){
-    pthread_mutex_init(&windows_mtx, NULL);
-}
+template<typename T, typename A>
+CountAggregator<T, A>::CountAggregator(const int tag, const int rank, const int worldSize) : 
+BasicVertex<T>(tag, rank, worldSize){}
 
-template<typename T>
-void CountAggregator<T>::streamProcess(int channel){
+template<typename T, typename A>
+void CountAggregator<T, A>::streamProcess(int channel){
     BasicVertex<T>::streamProcess(channel);    
 }
 
@@ -74,10 +91,9 @@ void CountAggregator<T>::streamProcess(int channel){
  * that a message is might correpond to mutiple windows in the case
  * of sliding windows for example).
  * */
-template<typename T>
-vector<output_data> CountAggregator<T>::processMessage(message_ptr message){
+template<typename T, typename A>
+vector<output_data> CountAggregator<T, A>::processMessage(message_ptr message){
 
-    int message_id = BasicVertex<T>::readMessageID(message);
     char input_baseline = BasicVertex<T>::readBaseline(message);
 
     if(input_baseline != BasicVertex<T>::getBaseline()){
@@ -90,55 +106,133 @@ vector<output_data> CountAggregator<T>::processMessage(message_ptr message){
 
     vector<output_data> res;
     vector<T> events = this->readEvents(message);
-    map<int, vector<T>> shards = shardEvents(events);
-    for (pair<const int, vector<T>>& window : shards){
-        const int window_id = window.first;
-        vector<T>& window_events = window.second;
+    map<int, A> shards = shardEvents(events);
+    map<int, vector<WrapperUnit>> units = shardWrapperUnits(message);
+
+    // windows of the events and of the wrapper units, in order
+    set<int> window_ids;
+    for (auto const& shard : shards) window_ids.insert(shard.first);
+    for (auto const& unit : units) window_ids.insert(unit.first);
+
+    for (const int window_id : window_ids){
+        Window* window = windows.lock(window_id);
+        if (window == nullptr){
+            continue; // the slot of the window already holds a newer one
+        }
+
+        if (isWindowExpired(window_id, *window)){
+            // too late, the events are dropped (a window with events
+            // not output yet is released once it has been fired)
+            if (window->accumulator.size() == 0) windows.release(window_id);
+            windows.unlock(window_id);
+            continue;
+        }
+
+        updateCompleteness(*window, units[window_id]);
 
-        updateCompleteness(window_id);
-        updateEvents(window_id, window_events);
+        auto shard = shards.find(window_id);
+        if (shard != shards.end()){
+            window->accumulator.merge(shard->second);
+        }
 
         // output something only if the window is finished
         // do not call the original processMessage or 
         // processEvent because we don't need it
-        if (isWindowComplete(window_id)){
-            vector<output_data> out = move(processWindow(windows[window_id].events));
-
-            for (output_data& data : out){
-                Serialization::wrap<char>(BasicVertex<T>::getBaseline(), data.first.get());
-                Serialization::wrap<int>(window_id, data.first.get());
+        // (the late events of a fired window are left to the subclass)
+        if (!window->fired && isWindowComplete(window_id, *window)){
+            for (output_data& data : fireWindow(window_id, *window)){
                 res.push_back(move(data));
             }
-            
-            pthread_mutex_lock(&windows_mtx);
-            windows.erase(window_id);
-            pthread_mutex_unlock(&windows_mtx);
-
         }
+
+        windows.unlock(window_id);
     }
 
     return res;
 }
 
-template<typename T>
-map<int, vector<T>> CountAggregator<T>::shardEvents(vector<T>& events){
-    map<int, vector<T>> res;
+/**
+ * Processes the events of a complete window and forgets the window once
+ * it is expired. The outputs carry the id of the window in their header.
+ * */
+template<typename T, typename A>
+vector<output_data> CountAggregator<T, A>::fireWindow(int window_id){
+    Window* window = windows.find(window_id);
+    if (window == nullptr){
+        return vector<output_data>();
+    }
+
+    vector<output_data> out = fireWindow(window_id, *window);
+    windows.unlock(window_id);
+
+    return out;
+}
+
+/**
+ * Same, with the slot of the window already locked. A window that was
+ * fired already outputs the delta of its late events.
+ * */
+template<typename T, typename A>
+vector<output_data> CountAggregator<T, A>::fireWindow(int window_id, Window& window){
+    vector<output_data> out = move(processWindow(window.accumulator));
+
+    for (output_data& data : out){
+        this->writeHeader(data.first.get(), window_id, window_id);
+
+        if (window.fired){
+            MessageHeader header = MessageHeader::read(data.first.get());
+            header.flags |= WINDOW_DELTA;
+            MessageHeader::write(header, data.first.get());
+        }
+    }
+
+    window.fired = true;
+    window.accumulator = A(); // the next result only covers the late events
+    if (isWindowExpired(window_id, window)){
+        windows.release(window_id);
+    }
+
+    return out;
+}
+
+/**
+ * Folds the events of a message per window, so that each window
+ * is locked once per message.
+ * */
+template<typename T, typename A>
+map<int, A> CountAggregator<T, A>::shardEvents(vector<T>& events){
+    map<int, A> res;
 
     for (const T& event : events){
         vector<int> window_ids = getWindowIDs(event); // implemented by user (might depend on the implementation of the event type)
         for (const int window_id : window_ids){
-            res.emplace(window_id, vector<T>({}));
-            res[window_id].push_back(event);
+            res[window_id].add(event);
         }
     }
 
     return res;
 }
 
+/**
+ * Messages of the count baseline have no wrapper unit.
+ * */
+template<typename T, typename A>
+map<int, vector<WrapperUnit>> CountAggregator<T, A>::shardWrapperUnits(const message_ptr&){
+    return map<int, vector<WrapperUnit>>();
+}
 
-template<typename T>
-bool CountAggregator<T>::isWindowComplete(int window_id){
-    return windows[window_id].completeness == getMaxCompleteness();
+template<typename T, typename A>
+bool CountAggregator<T, A>::isWindowComplete(int, const Window& window){
+    return window.completeness == (unsigned int) getMaxCompleteness();
+}
+
+/**
+ * The count baselines have no late events : a window is not needed
+ * anymore once it has been fired.
+ * */
+template<typename T, typename A>
+bool CountAggregator<T, A>::isWindowExpired(int, const Window& window){
+    return window.fired;
 }
 
 /**
@@ -155,44 +249,23 @@ bool CountAggregator<T>::isWindowComplete(int window_id){
 
 /**
  * Increase the number of messages detected for the givent window.
+ * Called with the slot of the window locked.
  * */
-template<typename T>
-void CountAggregator<T>::updateCompleteness(int window_id){
-    // update completeness information
-    if (windows.count(window_id) == 0){
-        pthread_mutex_lock(&windows_mtx);
-        windows.emplace(window_id, WindowInformation<T>()); // initialize a new window
-        pthread_mutex_unlock(&windows_mtx);
-    }
-
-    pthread_mutex_lock(&windows[window_id].lock);
-    windows[window_id].completeness++; // update completeness
-    pthread_mutex_unlock(&windows[window_id].lock);
-}
-
-/**
- * Stores the message events in the corresponding window storage.
- * */
-template<typename T>
-void CountAggregator<T>::updateEvents(int window_id, vector<T>& events){
-    
-    pthread_mutex_lock(&windows[window_id].lock);
-    for (size_t i = 0; i < events.size(); i++){
-        windows[window_id].events.push_back(events[i]); // copy
-    }
-    pthread_mutex_unlock(&windows[window_id].lock);
+template<typename T, typename A>
+void CountAggregator<T, A>::updateCompleteness(Window& window, const vector<WrapperUnit>&){
+    window.completeness++; // update completeness
 }
 
 /**
  * User may override this method to return the result they want
  * */
-template<typename T>
-vector<output_data> CountAggregator<T>::processWindow(const vector<T>& events){
+template<typename T, typename A>
+vector<output_data> CountAggregator<T, A>::processWindow(const A& accumulator){
     message_ptr message = this->createMessage(sizeof(size_t));
 
-    Serialization::wrap<size_t>(events.size(), message.get()); // change this if you do another implementation
+    Serialization::wrap<size_t>(accumulator.size(), message.get()); // change this if you do another implementation
     
     vector<output_data> res;
     res.push_back(make_pair(move(message), this->target_same_rank));
     return move(res);
-}
\ No newline at end of file
+}
@@ -41,6 +41,7 @@
 #include <vector>
 
 #include "Dataflow.hpp"
+#include "../communication/BufferAllocator.hpp"
 
 using namespace std;
 
@@ -114,6 +115,13 @@ void Dataflow::batchProcess() {
 
 void Dataflow::streamProcess() {
 
+	// fault the message buffers before the first messages are generated
+	if (BUFFER_PREFAULT)
+		BufferAllocator::reserve(BUFFER_POOL_SIZE, DEFAULT_WINDOW_SIZE);
+
+	if (CHAINING)
+		chain();
+
 	this->ALIVE = true;
 
 	pthread_t threads[vertices.size()];
@@ -139,6 +147,34 @@ void Dataflow::streamProcess() {
 	this->ALIVE = false;
 }
 
+/**
+ * Fuses the edges that never leave the rank: when a vertex sends all its
+ * output to its single successor on the same rank, and this successor has
+ * no other predecessor, the successor is run by the thread of the vertex.
+ * The records are then handed over with processBatch, without building,
+ * queueing and parsing an intermediate message.
+ */
+void Dataflow::chain() {
+
+	for (vector<Vertex*>::iterator vertex = vertices.begin();
+			vertex != vertices.end(); ++vertex) {
+
+		if ((*vertex)->next.size() != 1 || !(*vertex)->isForward())
+			continue;
+
+		Vertex* successor = (*vertex)->next[0];
+
+		if (successor->previous.size() == 1 && successor->isChainable()) {
+			(*vertex)->chainedNext = successor;
+			successor->chained = true;
+
+			if (rank == 0)
+				cout << "CHAINED VERTEX [" << (*vertex)->tag << "] -> ["
+						<< successor->tag << "]" << endl;
+		}
+	}
+}
+
 void* Dataflow::startRootThreadBatch(void* vertex) {
 
 	Vertex* currentVertex = (Vertex*) vertex;
@@ -64,6 +64,8 @@ public:
 
 private:
 
+	void chain();
+
 	// Internal root thread entry point
 	static void* startRootThreadBatch(void* vertex);
 
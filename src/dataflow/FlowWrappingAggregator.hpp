@@ -1,113 +1,84 @@
 #pragma once
 #include "CountAggregator.hpp"
 
-/**
- * Extending the base information of a window
- * to add the max completeness value.
- * */
-template<typename T>
-class WindowInformationFW : public WindowInformation<T> {
-            
-    public:
-        unsigned int max_completeness = 1;
-        WindowInformationFW() : WindowInformation<T>() {};
-};
-
 /**
  * This is a subclass of the count aggregator that processes
  * windows with wrapper units.
  * */
-template<typename T>
-class FlowWrappingAggregator : public CountAggregator<T> {
+template<typename T, typename A = BufferAccumulator<T>>
+class FlowWrappingAggregator : public CountAggregator<T, A> {
 
-    using WindowsFW = map<int, WindowInformationFW<T>>;
+    using Window = WindowInformation<T, A>;
 
     public:
         FlowWrappingAggregator(const int tag, const int rank, const int worldSize);
 
     protected:
-        virtual vector<output_data> processMessage(message_ptr message);
-        bool isWindowComplete(int window_id);
-        void updateFlowCompleteness(const WrapperUnit& unit);
+        bool isWindowComplete(int window_id, const Window& window);
+        void updateCompleteness(Window& window, const vector<WrapperUnit>& units);
+        map<int, vector<WrapperUnit>> shardWrapperUnits(const message_ptr& message);
         vector<WrapperUnit> extractWrapperUnits(const message_ptr& message);
-
-    private:
-        WindowsFW windows_fw;
-        pthread_mutex_t windows_mtx;
 };
 
-template<typename T>
-FlowWrappingAggregator<T>::FlowWrappingAggregator(const int tag, const int rank, const int worldSize):
-CountAggregator<T>(tag, rank, worldSize)
-{
-    pthread_mutex_init(&windows_mtx, NULL);
-}
+template<typename T, typename A>
+FlowWrappingAggregator<T, A>::FlowWrappingAggregator(const int tag, const int rank, const int worldSize):
+CountAggregator<T, A>(tag, rank, worldSize) {}
 
 /**
- * Overloading the message processing method allows us to process
- * the wrapper units before processing the messages normally.
+ * The wrapper units are given to the windows they belong to, the count
+ * aggregator's processMessage() then updates the completeness and the
+ * events of each window under the same lock : a window can't be output
+ * with the completeness of a message whose events aren't stored yet.
  * */
-template<typename T>
-vector<output_data> FlowWrappingAggregator<T>::processMessage(message_ptr message){
-    vector<WrapperUnit> wrapper_units = extractWrapperUnits(message);
-
-    pthread_mutex_lock(&windows_mtx);
-
-    // update before calling count aggregator's processMessage() method
-    // because it will call isWindowComplete to make sure the window is 
-    // finished and only the flow wrapping aggregator's completeness
-    // value is taken into account, so it must be up to date at that
-    // moment.
-    vector<long int> windows_to_remove;
-    for (const WrapperUnit& unit : wrapper_units){
-        updateFlowCompleteness(unit);
-
-        if (isWindowComplete(unit.window_start_time)) {
-            windows_to_remove.push_back(unit.window_start_time);
-        }
-    }
-
-    // shards events and everything...
-    // note : outputs a result if completeness is at max value
-    vector<output_data> res = CountAggregator<T>::processMessage(move(message));
+template<typename T, typename A>
+map<int, vector<WrapperUnit>> FlowWrappingAggregator<T, A>::shardWrapperUnits(const message_ptr& message){
+    map<int, vector<WrapperUnit>> res;
 
-    // remove complete windows once result has been outputed
-    for (auto const& window_id : windows_to_remove) {
-        windows_fw.erase(window_id);
+    // a message may carry several units of the same window
+    for (const WrapperUnit& unit : extractWrapperUnits(message)){
+        res[unit.window_start_time].push_back(unit);
     }
-    
-    pthread_mutex_unlock(&windows_mtx);
 
     return res;
 }
 
 /**
  * Updates numerator and denominator for flow-wrapping completeness
- * computation. 
+ * computation. Both fractions are brought to the least common
+ * denominator, so the units of a window don't need to share the same
+ * denominator (e.g. when a message spans several windows).
  * */
-template<typename T>
-void FlowWrappingAggregator<T>::updateFlowCompleteness(const WrapperUnit& unit){
-    unsigned int num = windows_fw[unit.window_start_time].completeness;
-    unsigned int den = windows_fw[unit.window_start_time].max_completeness;
-
-    if (den < unit.completeness_tag_denominator){
-        unsigned int factor = unit.completeness_tag_denominator / den; // we assume this always work for now
-        windows_fw[unit.window_start_time].max_completeness *= factor;
-        windows_fw[unit.window_start_time].completeness *= factor;
-        windows_fw[unit.window_start_time].completeness += unit.completeness_tag_numerator;
-    } else if (den == unit.completeness_tag_denominator){
-        windows_fw[unit.window_start_time].completeness += unit.completeness_tag_numerator;
-    } else {
-        throw "[FlowWrappingAggregator](updateCompleteness) Incorrect denominator value for a wrapping unit";
+template<typename T, typename A>
+void FlowWrappingAggregator<T, A>::updateCompleteness(Window& window, const vector<WrapperUnit>& units){
+    for (const WrapperUnit& unit : units){
+        if (unit.completeness_tag_denominator <= 0 || unit.completeness_tag_numerator < 0){
+            throw "[FlowWrappingAggregator](updateCompleteness) Incorrect completeness value for a wrapping unit";
+        }
+
+        unsigned int den = window.max_completeness;
+        unsigned int unit_den = unit.completeness_tag_denominator;
+
+        // least common multiple of both denominators
+        unsigned int a = den, b = unit_den;
+        while (b != 0){
+            unsigned int r = a % b;
+            a = b;
+            b = r;
+        }
+        const unsigned int lcm = den / a * unit_den;
+
+        window.completeness *= lcm / den;
+        window.max_completeness = lcm;
+        window.completeness += unit.completeness_tag_numerator * (lcm / unit_den);
     }
 }
 
 /**
  * replaces isWindowComplete from count aggregator
  * */
-template<typename T>
-bool FlowWrappingAggregator<T>::isWindowComplete(int window_id){
-    return windows_fw[window_id].completeness == windows_fw[window_id].max_completeness;
+template<typename T, typename A>
+bool FlowWrappingAggregator<T, A>::isWindowComplete(int, const Window& window){
+    return window.completeness == window.max_completeness;
 }
 
 /**
@@ -119,15 +90,14 @@ bool FlowWrappingAggregator<T>::isWindowComplete(int window_id){
  * To know how many wrapper units we have to read, there is an integer
  * in the header that gives us the number of wrapper units.
  * */
-template<typename T>
-vector<WrapperUnit> FlowWrappingAggregator<T>::extractWrapperUnits(const message_ptr& message){
+template<typename T, typename A>
+vector<WrapperUnit> FlowWrappingAggregator<T, A>::extractWrapperUnits(const message_ptr& message){
     vector<WrapperUnit> res;
 
-    int nof_wrapper_units = Serialization::unwrap<int>(message.get());
+    const int nof_wrapper_units = MessageHeader::peek(message.get()).nof_wrapper_units;
 
-    for (size_t i = 0; i < nof_wrapper_units; i++){
-        WrapperUnit unit = Serialization::unwrap<WrapperUnit>(message.get());
-        res.push_back(unit);
+    for (int i = 0; i < nof_wrapper_units; i++){
+        res.push_back(MessageHeader::readWrapperUnit(message.get(), i));
     }
 
     return res;
@@ -0,0 +1,327 @@
+#pragma once
+#include "CountAggregator.hpp"
+#include "Accumulator.hpp"
+
+#include <vector>
+#include <utility> // pair, declval
+#include <functional> // hash
+#include <type_traits> // decay
+
+/**
+ * State of a keyed window : one accumulator of type A per key, in a flat
+ * open addressing table (one array of slots, linear probing), so updating
+ * a key is a hash and a few probes, without any allocation once the table
+ * has grown. Consecutive events of the same key skip the hash.
+ *
+ * Events are (key, value) pairs, the values are added to the accumulator
+ * of their key. A keyed accumulator is itself an accumulator (cf.
+ * Accumulator.hpp) : the events of a message are folded in one per
+ * window before the window is locked, then merged in the window.
+ * */
+template<typename K, typename V, typename A>
+class KeyedAccumulator {
+
+    public:
+        void add(const pair<K, V>& event){
+            (*this)[event.first].add(event.second);
+            nof_events++;
+        }
+
+        void merge(const KeyedAccumulator<K, V, A>& other){
+            other.forEach([this](const K& key, const A& accumulator){
+                (*this)[key].merge(accumulator);
+            });
+            nof_events += other.nof_events;
+        }
+
+        A& operator[](const K& key); // creates the accumulator of the key if needed
+
+        // calls f(key, accumulator) for every key of the window
+        template<typename F>
+        void forEach(F f) const;
+
+        size_t size() const { // number of events added
+            return nof_events;
+        }
+
+        size_t nofKeys() const {
+            return nof_keys;
+        }
+
+    private:
+        struct Slot {
+            K key;
+            A accumulator;
+            bool used = false;
+        };
+
+        size_t slot(const K& key) const;
+        void rehash(const size_t capacity);
+
+        vector<Slot> slots;
+        size_t last = 0; // slot of the last key
+        size_t nof_keys = 0;
+        size_t nof_events = 0;
+};
+
+template<typename K, typename V, typename A>
+size_t KeyedAccumulator<K, V, A>::slot(const K& key) const {
+    size_t h = std::hash<K>()(key) * 0x9E3779B97F4A7C15ULL; // std::hash of integers is the identity
+    return (h ^ (h >> 29)) & (slots.size() - 1);
+}
+
+template<typename K, typename V, typename A>
+A& KeyedAccumulator<K, V, A>::operator[](const K& key){
+
+    if (nof_keys > 0 && slots[last].used && slots[last].key == key)
+        return slots[last].accumulator;
+
+    if ((nof_keys + 1) * 2 > slots.size())
+        rehash(slots.empty() ? 8 : slots.size() * 2); // windows start without memory
+
+    size_t i = slot(key);
+
+    while (slots[i].used && !(slots[i].key == key)) {
+        i = (i + 1) & (slots.size() - 1);
+    }
+
+    if (!slots[i].used) {
+        slots[i].used = true;
+        slots[i].key = key;
+        nof_keys++;
+    }
+
+    last = i;
+    return slots[i].accumulator;
+}
+
+template<typename K, typename V, typename A>
+template<typename F>
+void KeyedAccumulator<K, V, A>::forEach(F f) const {
+    for (const Slot& s : slots) {
+        if (s.used)
+            f(s.key, s.accumulator);
+    }
+}
+
+template<typename K, typename V, typename A>
+void KeyedAccumulator<K, V, A>::rehash(const size_t capacity){
+    vector<Slot> old_slots(capacity);
+    old_slots.swap(slots);
+
+    for (Slot& s : old_slots) {
+        if (!s.used) continue;
+
+        size_t i = slot(s.key);
+        while (slots[i].used) {
+            i = (i + 1) & (slots.size() - 1);
+        }
+
+        slots[i] = std::move(s);
+    }
+
+    last = 0;
+}
+
+/**
+ * Window assigner for the events whose key is their window id, e.g.
+ * when a combiner keys its partials by window (cf. winagg).
+ * */
+struct KeyWindows {
+    template<typename K, typename V>
+    vector<int> operator()(const pair<K, V>& event) const {
+        return vector<int>({(int) event.first});
+    }
+};
+
+/**
+ * Windowed aggregation of (key, value) events, per key, on top of one of
+ * the aggregation baselines :
+ *
+ *     KeyedWindowAggregator<K, V, A, WindowAssigner, ProgressPolicy>
+ *
+ * - A accumulates the values of a key (e.g. CountAccumulator<V>), its
+ *   result must be trivially copyable ;
+ * - WindowAssigner gives the windows of an event, vector<int>(const pair<K, V>&) ;
+ * - ProgressPolicy decides when a window is complete : CountAggregator,
+ *   FlowWrappingAggregator, SortAggregator or WatermarkAggregator. The
+ *   subclass still defines what the policy needs (getMaxCompleteness,
+ *   getWindowEnd...).
+ *
+ * The events of each message are combined per window and per key before
+ * the window is locked (cf. CountAggregator::shardEvents), so a window
+ * is updated once per message and key. A complete window outputs one
+ * (key, result) pair per key.
+ *
+ * As the final stage of a KeyedCombiner, the events are the (key, partial
+ * result) pairs of the combiners and A adds the partial results, e.g.
+ * A::add(const V&) sums the partial counts.
+ * */
+template<typename K, typename V, typename A, typename WindowAssigner,
+    template<typename, typename> class ProgressPolicy = CountAggregator>
+class KeyedWindowAggregator : public ProgressPolicy<pair<K, V>, KeyedAccumulator<K, V, A>> {
+
+    protected:
+        using Event = pair<K, V>;
+        using Keyed = KeyedAccumulator<K, V, A>;
+        using Result = typename std::decay<decltype(std::declval<const A&>().result())>::type;
+
+    public:
+        KeyedWindowAggregator(const int tag, const int rank, const int worldSize, WindowAssigner assigner = WindowAssigner());
+
+    protected:
+        vector<int> getWindowIDs(const Event& event);
+        vector<output_data> processWindow(const Keyed& accumulator);
+
+        WindowAssigner assigner;
+};
+
+template<typename K, typename V, typename A, typename WindowAssigner, template<typename, typename> class ProgressPolicy>
+KeyedWindowAggregator<K, V, A, WindowAssigner, ProgressPolicy>::KeyedWindowAggregator(const int tag, const int rank, const int worldSize, WindowAssigner assigner) :
+ProgressPolicy<Event, Keyed>(tag, rank, worldSize),
+assigner(assigner) {}
+
+template<typename K, typename V, typename A, typename WindowAssigner, template<typename, typename> class ProgressPolicy>
+vector<int> KeyedWindowAggregator<K, V, A, WindowAssigner, ProgressPolicy>::getWindowIDs(const Event& event){
+    return assigner(event);
+}
+
+/**
+ * Message = header + one (key, result) pair per key of the window.
+ * */
+template<typename K, typename V, typename A, typename WindowAssigner, template<typename, typename> class ProgressPolicy>
+vector<output_data> KeyedWindowAggregator<K, V, A, WindowAssigner, ProgressPolicy>::processWindow(const Keyed& accumulator){
+    message_ptr message = this->createMessage(accumulator.nofKeys() * sizeof(pair<K, Result>));
+
+    Message*const out = message.get();
+    accumulator.forEach([out](const K& key, const A& value){
+        Serialization::wrap<pair<K, Result>>(pair<K, Result>(key, value.result()), out);
+    });
+
+    vector<output_data> res;
+    res.push_back(make_pair(move(message), this->target_same_rank));
+    return res;
+}
+
+/**
+ * Partial stage of a keyed aggregation (combiner pushdown), in front of a
+ * KeyedWindowAggregator on every rank :
+ *
+ *     KeyedCombiner<T, K, A, WindowAssigner, KeySelector>
+ *         -> (key, partial) -> KeyedWindowAggregator<K, V, B, ..., ProgressPolicy>
+ *
+ * - T is the input event, A accumulates the events of a key (A::add(const T&)),
+ *   its result V is the partial result sent to the final stage ;
+ * - WindowAssigner gives the window of an event, int(const T&). Only
+ *   tumbling windows : the final stage finds the window of a partial
+ *   from its key or its value (e.g. KeyWindows when the key is the window) ;
+ * - KeySelector gives the key of an event, K(const T&).
+ *
+ * The events of each input message are folded per window and per key, then
+ * every rank receives one message with the partials of the keys it owns
+ * (cf. getRank) : the final stage gets one pair per key and message instead
+ * of every event. The messages keep the id and the wrapper units of their
+ * input (cf. mapWrapperUnit), so the final stage sees the same progress as
+ * if it read the inputs itself, whatever its ProgressPolicy. The combiner
+ * must have the baseline of the final stage (cf. setBaseline).
+ * */
+template<typename T, typename K, typename A, typename WindowAssigner, typename KeySelector>
+class KeyedCombiner : public BasicVertex<T> {
+
+    protected:
+        using Keyed = KeyedAccumulator<K, T, A>;
+        using Result = typename std::decay<decltype(std::declval<const A&>().result())>::type;
+        using Partial = pair<K, Result>;
+
+    public:
+        KeyedCombiner(const int tag, const int rank, const int worldSize,
+            WindowAssigner assigner = WindowAssigner(), KeySelector selector = KeySelector());
+
+    protected:
+        vector<output_data> processMessage(message_ptr message);
+        virtual int getRank(const K& key); // rank of the final stage owning the key, hash % worldSize by default
+        virtual WrapperUnit mapWrapperUnit(const WrapperUnit& unit); // unit in the window ids of the final stage, unchanged by default
+
+        WindowAssigner assigner;
+        KeySelector selector;
+};
+
+template<typename T, typename K, typename A, typename WindowAssigner, typename KeySelector>
+KeyedCombiner<T, K, A, WindowAssigner, KeySelector>::KeyedCombiner(const int tag, const int rank, const int worldSize,
+    WindowAssigner assigner, KeySelector selector) :
+BasicVertex<T>(tag, rank, worldSize),
+assigner(assigner),
+selector(selector) {}
+
+/**
+ * The events are read in place, and a message rarely covers more than
+ * one or two windows : the window of the previous event is tried first.
+ * */
+template<typename T, typename K, typename A, typename WindowAssigner, typename KeySelector>
+vector<output_data> KeyedCombiner<T, K, A, WindowAssigner, KeySelector>::processMessage(message_ptr message){
+    const MessageHeader input = this->readHeader(message);
+    const size_t offset = input.payloadOffset();
+    const size_t nof_events = (message->size - offset) / sizeof(T);
+
+    vector<pair<int, Keyed>> windows;
+    size_t w = 0;
+
+    for (size_t i = 0; i < nof_events; i++){
+        const T& event = Serialization::read_front<T>(message.get(), offset + i * sizeof(T));
+        const int window_id = assigner(event);
+
+        if (w == windows.size() || windows[w].first != window_id){
+            w = 0;
+            while (w < windows.size() && windows[w].first != window_id) w++;
+            if (w == windows.size()) windows.emplace_back(window_id, Keyed());
+        }
+
+        windows[w].second[selector(event)].add(event);
+    }
+
+    // partials of each rank
+    vector<vector<Partial>> partials(this->worldSize);
+    for (const pair<int, Keyed>& window : windows){
+        window.second.forEach([this, &partials](const K& key, const A& accumulator){
+            partials[getRank(key)].push_back(Partial(key, accumulator.result()));
+        });
+    }
+
+    MessageHeader header;
+    header.baseline = this->getBaseline();
+    header.message_id = input.message_id;
+    header.timestamp = input.timestamp;
+    header.watermark = this->getWatermark();
+    header.nof_wrapper_units = input.nof_wrapper_units;
+
+    const size_t header_length = MessageHeader::length(header.nof_wrapper_units);
+
+    vector<output_data> res;
+    for (int r = 0; r < this->worldSize; r++){
+        message_ptr out(new Message(header_length + partials[r].size() * sizeof(Partial)));
+
+        MessageHeader::write(header, out.get());
+        for (int u = 0; u < header.nof_wrapper_units; u++){
+            MessageHeader::writeWrapperUnit(mapWrapperUnit(MessageHeader::readWrapperUnit(message.get(), u)), u, out.get());
+        }
+        out->size = header_length;
+
+        for (const Partial& partial : partials[r]){
+            Serialization::wrap<Partial>(partial, out.get());
+        }
+
+        res.push_back(make_pair(move(out), vector<int>({r})));
+    }
+
+    return res;
+}
+
+template<typename T, typename K, typename A, typename WindowAssigner, typename KeySelector>
+int KeyedCombiner<T, K, A, WindowAssigner, KeySelector>::getRank(const K& key){
+    return std::hash<K>()(key) % this->worldSize;
+}
+
+template<typename T, typename K, typename A, typename WindowAssigner, typename KeySelector>
+WrapperUnit KeyedCombiner<T, K, A, WindowAssigner, KeySelector>::mapWrapperUnit(const WrapperUnit& unit){
+    return unit;
+}
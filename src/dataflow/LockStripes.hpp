@@ -0,0 +1,83 @@
+#pragma once
+#include "../communication/Window.hpp" // BUFFER_ALIGNMENT
+
+#include <vector>
+#include <pthread.h>
+
+static const int WINDOW_STRIPES = 16; // default number of stripes of the window states
+
+/**
+ * State of T split in stripes, each stripe with its own mutex : the
+ * windows (or any long key) are spread over the stripes, so that threads
+ * updating different windows don't wait for each other.
+ *
+ *     WindowState& state = stripes.lock(WID);
+ *     ... // only the windows of this stripe can be used
+ *     stripes.unlock(WID);
+ *
+ * A thread must not lock two stripes at the same time.
+ * */
+template<typename T>
+class LockStripes {
+
+    public:
+        explicit LockStripes(const int nof_stripes = WINDOW_STRIPES);
+        ~LockStripes();
+
+        LockStripes(const LockStripes&) = delete;
+        LockStripes& operator=(const LockStripes&) = delete;
+
+        T& lock(const long int key);
+        void unlock(const long int key);
+
+        int size() const;
+
+    private:
+        struct Stripe {
+            pthread_mutex_t mutex;
+            T state;
+            char padding[BUFFER_ALIGNMENT]; // keeps the mutexes on different cache lines
+        };
+
+        Stripe& stripe(const long int key);
+
+        std::vector<Stripe> stripes;
+};
+
+template<typename T>
+LockStripes<T>::LockStripes(const int nof_stripes) :
+stripes(nof_stripes) {
+    for (Stripe& stripe : stripes){
+        pthread_mutex_init(&stripe.mutex, NULL);
+    }
+}
+
+template<typename T>
+LockStripes<T>::~LockStripes(){
+    for (Stripe& stripe : stripes){
+        pthread_mutex_destroy(&stripe.mutex);
+    }
+}
+
+template<typename T>
+typename LockStripes<T>::Stripe& LockStripes<T>::stripe(const long int key){
+    const long int index = key % (long int) stripes.size();
+    return stripes[index < 0 ? index + stripes.size() : index];
+}
+
+template<typename T>
+T& LockStripes<T>::lock(const long int key){
+    Stripe& s = stripe(key);
+    pthread_mutex_lock(&s.mutex);
+    return s.state;
+}
+
+template<typename T>
+void LockStripes<T>::unlock(const long int key){
+    pthread_mutex_unlock(&stripe(key).mutex);
+}
+
+template<typename T>
+int LockStripes<T>::size() const {
+    return stripes.size();
+}
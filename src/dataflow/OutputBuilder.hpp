@@ -0,0 +1,154 @@
+#pragma once
+#include "../communication/Message.hpp"
+
+#include <vector>
+#include <algorithm> // max
+#include <memory> // unique_ptr
+#include <utility> // pair
+#include <cstring> // memcpy
+#include <sstream>
+
+// these unique_ptr will make sure the ownership of the
+// message objects is correctly transferred
+using std::unique_ptr;
+using std::vector;
+using std::pair;
+using message_ptr = unique_ptr<Message>;
+using destination = vector<int>;
+using output_data = pair<message_ptr, destination>;
+
+/**
+ * Collects the records an operator produces into one growing
+ * message per destination rank, so that an input message (or a
+ * batch of input messages) results in at most one output message
+ * per destination instead of one message per produced record.
+ *
+ * The builder only manages the message bodies. It reserves
+ * header_size bytes at the front of every message it creates, so
+ * the owner (usually a BasicVertex) can write the message header
+ * exactly once when the builder is flushed.
+ *
+ * A builder is not thread safe: use one builder per processing
+ * thread (the builders are cheap when they are empty, messages
+ * are only allocated on the first append to a destination).
+ * */
+class OutputBuilder {
+
+    public:
+        OutputBuilder(const int worldSize, const unsigned int header_size, const size_t initial_capacity = 0);
+
+        template<typename R>
+        void append(const R& record, const int rank);
+
+        template<typename R>
+        void append(const R& record, const destination& ranks);
+
+        void append(const char* data, const size_t length, const int rank);
+
+        bool empty() const;
+        bool empty(const int rank) const;
+        size_t size(const int rank) const; // body size, header excluded
+
+        // hands over the non-empty messages, one per destination rank,
+        // and leaves the builder empty so that it can be reused
+        vector<output_data> flush();
+
+    private:
+        void reserve(const int rank, const size_t length);
+
+        int worldSize;
+        unsigned int header_size;
+        size_t initial_capacity;
+        vector<message_ptr> messages; // one (lazily allocated) message per rank
+};
+
+inline OutputBuilder::OutputBuilder(const int worldSize, const unsigned int header_size, const size_t initial_capacity) :
+worldSize(worldSize),
+header_size(header_size),
+initial_capacity(initial_capacity),
+messages(worldSize) {}
+
+/**
+ * Appends a POD record to the message of the given rank.
+ * */
+template<typename R>
+void OutputBuilder::append(const R& record, const int rank){
+    append(reinterpret_cast<const char*>(&record), sizeof(R), rank);
+}
+
+/**
+ * Appends a copy of a POD record to the message of every given rank.
+ * */
+template<typename R>
+void OutputBuilder::append(const R& record, const destination& ranks){
+    for (const int rank : ranks){
+        append(reinterpret_cast<const char*>(&record), sizeof(R), rank);
+    }
+}
+
+/**
+ * Appends raw bytes to the message of the given rank, growing
+ * the message if its capacity is too small.
+ * */
+inline void OutputBuilder::append(const char* data, const size_t length, const int rank){
+    if (rank < 0 || rank >= worldSize){
+        std::stringstream ss;
+        ss << "[OutputBuilder](append) Destination rank does not exist : " << rank;
+        throw ss.str();
+    }
+
+    reserve(rank, length);
+
+    Message* message = messages[rank].get();
+    memcpy(message->buffer + message->size, data, length);
+    message->size += length;
+}
+
+/**
+ * Makes sure the message of the given rank can receive length more
+ * bytes. New messages start after the reserved header space. 
+ * Capacity is doubled to amortize the copies.
+ * */
+inline void OutputBuilder::reserve(const int rank, const size_t length){
+    message_ptr& message = messages[rank];
+
+    if (message == nullptr){
+        const size_t capacity = std::max(initial_capacity, length) + header_size;
+        message = message_ptr(new Message(capacity));
+        message->size = header_size;
+    } else if (message->size + length > (size_t) message->capacity){
+        const size_t capacity = std::max((size_t) message->capacity * 2, message->size + length);
+        message_ptr grown(new Message(capacity));
+        memcpy(grown->buffer, message->buffer, message->size);
+        grown->size = message->size;
+        message = std::move(grown);
+    }
+}
+
+inline bool OutputBuilder::empty() const {
+    for (const message_ptr& message : messages){
+        if (message != nullptr) return false;
+    }
+    return true;
+}
+
+inline bool OutputBuilder::empty(const int rank) const {
+    return messages[rank] == nullptr;
+}
+
+inline size_t OutputBuilder::size(const int rank) const {
+    return messages[rank] == nullptr ? 0 : messages[rank]->size - header_size;
+}
+
+inline vector<output_data> OutputBuilder::flush(){
+    vector<output_data> res;
+
+    for (int rank = 0; rank < worldSize; rank++){
+        if (messages[rank] != nullptr){
+            res.push_back(std::make_pair(std::move(messages[rank]), destination({rank})));
+            messages[rank] = nullptr;
+        }
+    }
+
+    return res;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "../communication/Message.hpp"
+#include "../communication/MessageHeader.hpp"
+
+#include <type_traits>
+#include <sstream>
+
+/**
+ * Records handed over by a vertex to the successor it is chained with
+ * (see Dataflow::chain), in place of a serialized message.
+ *
+ * The batch does not own the records, they are only valid during the
+ * processBatch call. The message the records originate from is kept,
+ * so that chained vertices read the same header and wrapper units as
+ * if the message had been sent to them.
+ * */
+struct RecordBatch {
+
+    const Message* origin; // message at the head of the chain
+    const void* records;
+    int count;
+
+    RecordBatch(const Message* origin, const void* records, const int count);
+
+    template<typename R>
+    const R* as() const;
+
+    template<typename R>
+    static RecordBatch of(const Message* message);
+};
+
+inline RecordBatch::RecordBatch(const Message* origin, const void* records, const int count) :
+origin(origin),
+records(records),
+count(count) {}
+
+template<typename R>
+const R* RecordBatch::as() const {
+    return static_cast<const R*>(records);
+}
+
+/**
+ * Batch of the records stored in the body of the message, read in
+ * place: the body is aligned (see MessageHeader::length) and the
+ * records are stored as they are in memory.
+ * */
+template<typename R>
+RecordBatch RecordBatch::of(const Message* message){
+    static_assert(std::is_trivially_copyable<R>::value, "records must be trivially copyable to be read in place");
+    static_assert(BUFFER_ALIGNMENT % alignof(R) == 0, "records must not need a stricter alignment than the message body");
+
+    const size_t offset = MessageHeader::peek(message).payloadOffset();
+
+    if ((size_t) message->size < offset || (message->size - offset) % sizeof(R) != 0){
+        std::stringstream ss;
+        ss << "[RecordBatch](of) Message body is not made of whole records : " << message->size - (int) offset << " bytes";
+        throw ss.str();
+    }
+
+    return RecordBatch(message, message->buffer + offset, (message->size - offset) / sizeof(R));
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vector>
+#include <algorithm> // push_heap, pop_heap
+#include <functional> // greater
+#include <utility> // move
+
+/**
+ * Holds the messages that arrived out of order until the expected one
+ * is there : messages are pushed with a key (e.g. their message id, or
+ * a (message id, window id) pair) and released in the order of the keys.
+ *
+ *     buffer.push(key, message);
+ *     while (!buffer.empty() && buffer.frontKey() == expected_key){
+ *         M message = buffer.pop();
+ *         ...
+ *     }
+ *
+ * The buffer is a binary min-heap : pushing costs O(log n) and reading
+ * the smallest key O(1), instead of sorting every waiting message each
+ * time new ones arrive. Messages with the same key are released in any
+ * order. A buffer is not thread safe.
+ * */
+template<typename M, typename K = long int>
+class ReorderBuffer {
+
+    public:
+        void push(const K& key, M message);
+        M pop(); // removes the message with the smallest key
+
+        const K& frontKey() const;
+        const M& front() const;
+
+        bool empty() const;
+        size_t size() const;
+
+    private:
+        struct Entry {
+            K key;
+            M message;
+
+            bool operator>(const Entry& other) const {
+                return other.key < key;
+            }
+        };
+
+        std::vector<Entry> heap;
+};
+
+template<typename M, typename K>
+void ReorderBuffer<M, K>::push(const K& key, M message){
+    heap.push_back(Entry{key, std::move(message)});
+    std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+}
+
+template<typename M, typename K>
+M ReorderBuffer<M, K>::pop(){
+    std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+    M message = std::move(heap.back().message);
+    heap.pop_back();
+    return message;
+}
+
+template<typename M, typename K>
+const K& ReorderBuffer<M, K>::frontKey() const {
+    return heap.front().key;
+}
+
+template<typename M, typename K>
+const M& ReorderBuffer<M, K>::front() const {
+    return heap.front().message;
+}
+
+template<typename M, typename K>
+bool ReorderBuffer<M, K>::empty() const {
+    return heap.empty();
+}
+
+template<typename M, typename K>
+size_t ReorderBuffer<M, K>::size() const {
+    return heap.size();
+}
@@ -0,0 +1,164 @@
+#pragma once
+#include "Vertex.hpp"
+#include "../communication/Message.hpp"
+#include "../serialization/Codec.hpp"
+
+#include <vector>
+#include <list>
+
+/**
+ * Where the results of a dataflow are collected :
+ * - SINK_ROOT : every result is sent to rank 0
+ * - SINK_TREE : results reach rank 0 through a SINK_FAN_IN-ary tree of
+ *   TreeReducer vertices, so that no rank receives from more than
+ *   SINK_FAN_IN ranks
+ * - SINK_DISTRIBUTED : every rank collects (and writes) its own results,
+ *   only small summaries reach rank 0 through the tree
+ * */
+enum SinkMode {
+	SINK_ROOT, SINK_TREE, SINK_DISTRIBUTED
+};
+
+static const SinkMode SINK_MODE = SINK_DISTRIBUTED;
+
+static const int SINK_FAN_IN = 4;
+
+/**
+ * Shape of the reduction tree : rank r sends to parent(r, 0), the first
+ * rank of its group of SINK_FAN_IN ranks. The ranks receiving at level l
+ * are the multiples of SINK_FAN_IN^(l+1), and send to parent(r, l+1). The
+ * last level only has rank 0.
+ * */
+class SinkTree {
+
+public:
+
+	// number of levels, the tree has levels(worldSize) - 1 TreeReducer vertices
+	static int levels(const int worldSize, const int fan_in = SINK_FAN_IN) {
+		int levels = 1;
+		for (long span = fan_in; span < worldSize; span *= fan_in)
+			levels++;
+		return levels;
+	}
+
+	static long span(const int level, const int fan_in = SINK_FAN_IN) {
+		long span = 1;
+		for (int l = 0; l <= level; l++)
+			span *= fan_in;
+		return span;
+	}
+
+	static int parent(const int rank, const int level, const int fan_in = SINK_FAN_IN) {
+		return rank - rank % span(level, fan_in);
+	}
+
+	static bool receives(const int rank, const int level, const int fan_in = SINK_FAN_IN) {
+		return rank % span(level, fan_in) == 0;
+	}
+
+	// rank the results produced at the given rank are sent to
+	static int resultRank(const int rank) {
+		switch (SINK_MODE) {
+		case SINK_TREE:
+			return parent(rank, 0);
+		case SINK_DISTRIBUTED:
+			return rank;
+		default:
+			return 0;
+		}
+	}
+};
+
+/**
+ * Inner node of the reduction tree at the given level : forwards the records
+ * received from its children to its parent. All the messages found in the
+ * input queue of a channel are combined into a single message, so the upper
+ * levels receive fewer and larger messages.
+ *
+ * Records are exchanged without header, as POD records of type R. The
+ * successor of the last level only receives on rank 0.
+ * */
+template<typename R>
+class TreeReducer: public Vertex {
+
+public:
+
+	TreeReducer(int tag, int rank, int worldSize, int level);
+
+	void streamProcess(int channel);
+
+protected:
+
+	// called on the records of each outgoing message, e.g. to merge summaries
+	virtual void combine(std::vector<R>& records);
+
+	int level;
+};
+
+template<typename R>
+TreeReducer<R>::TreeReducer(int tag, int rank, int worldSize, int level) :
+		Vertex(tag, rank, worldSize), level(level) {
+}
+
+template<typename R>
+void TreeReducer<R>::combine(std::vector<R>&) {
+}
+
+template<typename R>
+void TreeReducer<R>::streamProcess(int channel) {
+
+	if (!SinkTree::receives(rank, level))
+		return;
+
+	std::list<Message*> tmpMessages;
+	std::vector<R> records;
+
+	while (ALIVE) {
+
+		pthread_mutex_lock(&listenerMutexes[channel]);
+
+		while (inMessages[channel].empty())
+			pthread_cond_wait(&listenerCondVars[channel],
+					&listenerMutexes[channel]);
+
+		while (!inMessages[channel].empty()) {
+			tmpMessages.push_back(inMessages[channel].front());
+			inMessages[channel].pop_front();
+		}
+
+		pthread_mutex_unlock(&listenerMutexes[channel]);
+
+		records.clear();
+		while (!tmpMessages.empty()) {
+			Message* inMessage = tmpMessages.front();
+			tmpMessages.pop_front();
+
+			std::vector<R> received = Codec<R>::decode(inMessage, 0);
+			records.insert(records.end(), received.begin(), received.end());
+
+			delete inMessage;
+		}
+
+		combine(records);
+
+		if (records.empty())
+			continue;
+
+		Message* outMessage = new Message(records.size() * sizeof(R));
+		Codec<R>::encode(records, outMessage);
+
+		int n = 0;
+		for (vector<Vertex*>::iterator v = next.begin(); v != next.end(); ++v) {
+
+			int idx = n * worldSize + SinkTree::parent(rank, level + 1);
+
+			pthread_mutex_lock(&senderMutexes[idx]);
+			outMessages[idx].push_back(outMessage);
+			pthread_cond_signal(&senderCondVars[idx]);
+			pthread_mutex_unlock(&senderMutexes[idx]);
+
+			n++;
+			break; // only one successor node allowed!
+		}
+	}
+}
@@ -1,23 +1,28 @@
 #include "CountAggregator.hpp"
+#include "ReorderBuffer.hpp"
 
 
 /**
  * One of the three baselines for aggregation.
- * Reads messages in order (based on message id).
+ * Reads messages in order (based on message id), the messages
+ * that arrive too early wait in a reorder buffer per channel.
  * */
-template<typename T>
-class SortAggregator : public CountAggregator<T> {
+template<typename T, typename A = BufferAccumulator<T>>
+class SortAggregator : public CountAggregator<T, A> {
 
     public:
         SortAggregator(int tag, int rank, int worldSize);
 
     protected:
-        message_ptr fetchNextMessage(int channel, list<message_ptr>& pthread_waiting_list);
-        void updateInputMessages(const int channel, list<message_ptr>& pthread_waiting_list);
+        using Buffer = ReorderBuffer<message_ptr, int>;
+
+        message_ptr fetchNextMessage(int channel);
+        void updateInputMessages(const int channel, Buffer& buffer);
         bool isExpected(const message_ptr& message);
-        void sortMessages(list<message_ptr>& pthread_waiting_list);
+        Buffer& getReorderBuffer(const int channel);
 
         pthread_mutex_t mtx_sort;
+        map<int, Buffer> reorder_buffers; // one per channel
 
         int previous_wid = -1;
         int expected_msgid = 0;
@@ -27,9 +32,9 @@ class SortAggregator : public CountAggregator<T> {
 /**
  * Basic constructor extending the count baseline
  * */
-template<typename T>
-SortAggregator<T>::SortAggregator(int tag, int rank, int worldSize) :
-CountAggregator<T>(tag, rank, worldSize){
+template<typename T, typename A>
+SortAggregator<T, A>::SortAggregator(int tag, int rank, int worldSize) :
+CountAggregator<T, A>(tag, rank, worldSize){
     pthread_mutex_init(&mtx_sort, NULL);
 }
 
@@ -38,50 +43,44 @@ CountAggregator<T>(tag, rank, worldSize){
  * for new messages as long as they are not in order, and not simply
  * wait for the first message to arrive.
  * */
-template<typename T>
-message_ptr SortAggregator<T>::fetchNextMessage(int channel, list<message_ptr>& pthread_waiting_list){
-    
-    while(pthread_waiting_list.empty() || !isExpected(pthread_waiting_list.front())){
-        updateInputMessages(channel, pthread_waiting_list);
-    }
+template<typename T, typename A>
+message_ptr SortAggregator<T, A>::fetchNextMessage(int channel){
+    Buffer& buffer = getReorderBuffer(channel);
 
-    message_ptr message = move(pthread_waiting_list.front()); // move expected message
-    pthread_waiting_list.pop_front(); // pop empty ptr
+    while(buffer.empty() || !isExpected(buffer.front())){
+        updateInputMessages(channel, buffer);
+    }
 
-    return message;
+    return buffer.pop(); // expected message
 }
 
 /**
  * This part of the code looks for new messages once
- * and sorts the messages received depending on their 
+ * and orders the messages received depending on their 
  * message id value.
  * */
-template<typename T>
-void SortAggregator<T>::updateInputMessages(int channel, list<message_ptr>& pthread_waiting_list){
+template<typename T, typename A>
+void SortAggregator<T, A>::updateInputMessages(int channel, Buffer& buffer){
     // wait for new messages to arrive
     vector<message_ptr> fetched = BasicVertex<T>::fetchMessages(channel);
 
     for (size_t i = 0; i < fetched.size(); i++){
-        pthread_waiting_list.push_back(move(fetched[i]));
+        const int message_id = MessageHeader::peek(fetched[i].get()).message_id;
+        buffer.push(message_id, move(fetched[i]));
     }
-
-    // now we are certain there are messages in the
-    // waiting list, we can sort them.
-    sortMessages(pthread_waiting_list);
 }
 
 /**
- * Sorts input messages by message id
+ * Each channel is read by a single thread, which is the only
+ * one using the buffer of the channel.
  * */
-template<typename T>
-void SortAggregator<T>::sortMessages(list<message_ptr>& pthread_waiting_list){
-    pthread_waiting_list.sort(
-		[](const message_ptr & a, const message_ptr & b){
-		int a_msgid = Serialization::read_back<int>(a.get());
-		int b_msgid = Serialization::read_back<int>(b.get());
-		
-		return (a_msgid < b_msgid);
-	});
+template<typename T, typename A>
+typename SortAggregator<T, A>::Buffer& SortAggregator<T, A>::getReorderBuffer(const int channel){
+    pthread_mutex_lock(&mtx_sort);
+    Buffer& buffer = reorder_buffers[channel]; // references to map elements stay valid
+    pthread_mutex_unlock(&mtx_sort);
+
+    return buffer;
 }
 
 /**
@@ -97,9 +96,9 @@ void SortAggregator<T>::sortMessages(list<message_ptr>& pthread_waiting_list){
  * each thread will receive different ids so the implementation
  * might change a lot).
  * */
-template<typename T>
-bool SortAggregator<T>::isExpected(const message_ptr& message){
-    int message_id = Serialization::read_back<int>(message.get());
+template<typename T, typename A>
+bool SortAggregator<T, A>::isExpected(const message_ptr& message){
+    int message_id = MessageHeader::peek(message.get()).message_id;
 
     if (expected_msgid == message_id){
 
@@ -119,4 +118,4 @@ bool SortAggregator<T>::isExpected(const message_ptr& message){
     else {
         return false;
     }
-}
\ No newline at end of file
+}
\ No newline at end of file
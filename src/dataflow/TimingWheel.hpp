@@ -0,0 +1,171 @@
+#pragma once
+
+#include <vector>
+#include <utility> // move
+#include <pthread.h>
+
+static const int WHEEL_LEVELS = 4; // a wheel covers 64^4 ticks, later timers wait in an overflow list
+static const int WHEEL_BITS = 6; // 64 slots per level
+
+/**
+ * Hierarchical timing wheel : timers on payloads of type P (e.g. window
+ * ids) that expire once the time of the wheel reaches their tick. The
+ * time can be a processing time (e.g. milliseconds of MPI_Wtime) or a
+ * watermark, in any unit, as long as it never goes backwards.
+ *
+ *     TimingWheel<int> timers(now);
+ *     timers.schedule(now + delay, window_id); // window end, early firing, expiry...
+ *     for (int window_id : timers.advance(now)){
+ *         ... // the window may already be gone, timers are not cancelled
+ *     }
+ *
+ * Level l has 64 slots of 64^l ticks. A timer is stored at the lowest
+ * level where it shares the higher bits of its tick with the current
+ * time, and moves down one level each time the slot above is reached :
+ * scheduling and firing are amortized O(1), whatever the number of open
+ * windows. Payloads are returned in the order of their ticks.
+ *
+ * The wheel is thread safe, the payloads are handled by the caller
+ * outside of its lock.
+ * */
+template<typename P>
+class TimingWheel {
+
+    public:
+        explicit TimingWheel(const long int start = 0);
+        ~TimingWheel();
+
+        TimingWheel(const TimingWheel&) = delete;
+        TimingWheel& operator=(const TimingWheel&) = delete;
+
+        void schedule(const long int tick, const P& payload); // past ticks expire with the next advance
+        std::vector<P> advance(const long int now); // payloads of the expired timers
+
+        size_t size();
+
+    private:
+        struct Timer {
+            long int tick;
+            P payload;
+        };
+
+        static const int SLOTS = 1 << WHEEL_BITS;
+
+        void insert(Timer timer);
+        void cascade(const int level);
+
+        std::vector<std::vector<Timer>> slots; // WHEEL_LEVELS * SLOTS
+        std::vector<Timer> overflow;
+        std::vector<P> expired;
+        long int current;
+        size_t nof_timers;
+        pthread_mutex_t mutex;
+};
+
+template<typename P>
+TimingWheel<P>::TimingWheel(const long int start) :
+slots(WHEEL_LEVELS * SLOTS),
+current(start),
+nof_timers(0) {
+    pthread_mutex_init(&mutex, NULL);
+}
+
+template<typename P>
+TimingWheel<P>::~TimingWheel(){
+    pthread_mutex_destroy(&mutex);
+}
+
+template<typename P>
+void TimingWheel<P>::schedule(const long int tick, const P& payload){
+    pthread_mutex_lock(&mutex);
+    insert(Timer{tick, payload});
+    nof_timers++;
+    pthread_mutex_unlock(&mutex);
+}
+
+/**
+ * Finds the level of a timer from the highest bit its tick doesn't share
+ * with the current time. Must be called with the mutex locked.
+ * */
+template<typename P>
+void TimingWheel<P>::insert(Timer timer){
+    if (timer.tick <= current){
+        expired.push_back(std::move(timer.payload));
+        return;
+    }
+
+    for (int level = 0; level < WHEEL_LEVELS; level++){
+        const int shift = WHEEL_BITS * (level + 1);
+        if ((timer.tick >> shift) == (current >> shift)){
+            const int slot = (timer.tick >> (WHEEL_BITS * level)) & (SLOTS - 1);
+            slots[level * SLOTS + slot].push_back(std::move(timer));
+            return;
+        }
+    }
+
+    overflow.push_back(std::move(timer));
+}
+
+/**
+ * Moves the timers of the current slot of a level to the lower levels.
+ * Must be called with the mutex locked.
+ * */
+template<typename P>
+void TimingWheel<P>::cascade(const int level){
+    std::vector<Timer> timers;
+
+    if (level == WHEEL_LEVELS){
+        timers.swap(overflow);
+    } else {
+        const int slot = (current >> (WHEEL_BITS * level)) & (SLOTS - 1);
+        timers.swap(slots[level * SLOTS + slot]);
+    }
+
+    for (Timer& timer : timers){
+        insert(std::move(timer));
+    }
+}
+
+template<typename P>
+std::vector<P> TimingWheel<P>::advance(const long int now){
+    pthread_mutex_lock(&mutex);
+
+    while (current < now){
+        if (nof_timers == expired.size()){
+            current = now; // nothing to fire on the way
+            break;
+        }
+
+        current++;
+
+        // the slots reached at the higher levels go down first
+        int level = 1;
+        while (level <= WHEEL_LEVELS && (current & ((1L << (WHEEL_BITS * level)) - 1)) == 0){
+            level++;
+        }
+        for (int l = level - 1; l >= 1; l--){
+            cascade(l);
+        }
+
+        std::vector<Timer>& slot = slots[current & (SLOTS - 1)];
+        for (Timer& timer : slot){
+            expired.push_back(std::move(timer.payload));
+        }
+        slot.clear();
+    }
+
+    std::vector<P> res;
+    res.swap(expired);
+    nof_timers -= res.size();
+
+    pthread_mutex_unlock(&mutex);
+    return res;
+}
+
+template<typename P>
+size_t TimingWheel<P>::size(){
+    pthread_mutex_lock(&mutex);
+    const size_t res = nof_timers;
+    pthread_mutex_unlock(&mutex);
+    return res;
+}
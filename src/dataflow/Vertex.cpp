@@ -72,6 +72,10 @@ Vertex::Vertex(int tag, int rank, int worldSize) {
 
 	this->listeningThreadsBatch = 0;
 
+	this->chainedNext = nullptr;
+	this->chained = false;
+	this->chainedThreads = 1;
+
 	this->ALIVE = false;
 	this->BYTES_SENT = 0;
 	this->BYTES_RECEIVED = 0;
@@ -165,6 +169,18 @@ void Vertex::streamProcess(int channel) {
 	cout << "WARNING: CALL TO GENERIC VERTEX.STREAMPROCESS!" << endl;
 }
 
+bool Vertex::isChainable() {
+	return false;
+}
+
+bool Vertex::isForward() {
+	return false;
+}
+
+void Vertex::processBatch(const RecordBatch&, int) {
+	cout << "WARNING: CALL TO GENERIC VERTEX.PROCESSBATCH!" << endl;
+}
+
 void Vertex::startThreadsBatch() {
 
 	int i = 0;
@@ -269,8 +285,8 @@ if(this->ALIVE == false){
 	this->ALIVE = true;
 
 	int p = 0;
-	for (vector<Vertex*>::iterator v = previous.begin(); v != previous.end();
-			++v) {
+	for (vector<Vertex*>::iterator v = previous.begin(); v != previous.end()
+			&& !chained; ++v) { // a chained vertex is run by its predecessor
 
 		for (int i = 0; i < worldSize; i++) {
 
@@ -297,7 +313,7 @@ if(this->ALIVE == false){
 	int n = 0;
 	for (vector<Vertex*>::iterator v = next.begin(); v != next.end(); ++v) {
 
-		for (int i = 0; i < worldSize; i++) {
+		for (int i = 0; i < worldSize && (*v) != chainedNext; i++) {
 
 			int idx = n * worldSize + i;
 
@@ -323,8 +339,8 @@ if(this->ALIVE == false){
 void Vertex::joinThreadsStream() {
 
 	int p = 0;
-	for (vector<Vertex*>::iterator v = previous.begin(); v != previous.end();
-			++v) {
+	for (vector<Vertex*>::iterator v = previous.begin(); v != previous.end()
+			&& !chained; ++v) {
 
 		for (int i = 0; i < worldSize; i++) {
 
@@ -343,7 +359,7 @@ void Vertex::joinThreadsStream() {
 
 		(*v)->joinThreadsStream();
 
-		for (int i = 0; i < worldSize; i++) {
+		for (int i = 0; i < worldSize && (*v) != chainedNext; i++) {
 
 			int idx = n * worldSize + i;
 			pthread_join(senderThreadsStream[idx], (void **) NULL);
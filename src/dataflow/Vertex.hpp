@@ -69,11 +69,14 @@
 #include "../function/Function.hpp"
 #include "../partitioning/Partition.hpp"
 #include "../serialization/Serialization.hpp"
+#include "RecordBatch.hpp"
 
 using namespace std;
 
 static const bool PIPELINE = false; //true;
 
+static const bool CHAINING = true; // fuse same-rank forward edges (see Dataflow::chain)
+
 static const bool SANITY_CHECK = false;
 
 class Vertex;
@@ -123,6 +126,12 @@ public:
 
 	vector<Vertex*> next, previous;
 
+	Vertex* chainedNext; // successor fused with this vertex, receives our records directly
+
+	bool chained; // fused with its predecessor: no listener & processor threads
+
+	int chainedThreads; // threads of the rank running this vertex in chained mode, on one channel each
+
 	Vertex(int tag, int rank, int worldSize);
 
 	// Virtual functions - to be overwritten by subclasses
@@ -133,6 +142,14 @@ public:
 
 	virtual void streamProcess(int channel);
 
+	// Operator chaining - to be overwritten by chainable subclasses
+
+	virtual bool isChainable(); // implements processBatch
+
+	virtual bool isForward(); // sends all its output to its single successor on the same rank
+
+	virtual void processBatch(const RecordBatch& batch, int channel);
+
 	// Non-virtual functions - only defined in superclass
 
 	void initialize();
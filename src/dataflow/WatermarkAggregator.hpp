@@ -0,0 +1,142 @@
+#pragma once
+#include "CountAggregator.hpp"
+
+/**
+ * This is a subclass of the count aggregator that processes windows
+ * on event-time watermarks instead of counting messages : a window is
+ * complete once the low watermark of the vertex (the minimum over its
+ * input channels, cf. BasicVertex::getWatermark) has passed its end.
+ *
+ * Unlike the other baselines, the aggregator doesn't need to know how
+ * many messages the upstream operators send, the sources only have to
+ * write a watermark in the header of their messages.
+ *
+ * A window is kept for getAllowedLateness() after its end : the events
+ * that arrive behind the watermark during that time are output as a
+ * delta of their window (flagged WINDOW_DELTA, the consumer merges it
+ * with the earlier results), later events are dropped. The late events
+ * of a window are gathered until the watermark moves, so a window
+ * outputs at most one delta per watermark. The sources can then send
+ * watermarks that don't wait for their slowest messages.
+ * */
+template<typename T, typename A = BufferAccumulator<T>>
+class WatermarkAggregator : public CountAggregator<T, A> {
+
+    public:
+        WatermarkAggregator(const int tag, const int rank, const int worldSize);
+        virtual void streamProcess(int channel);
+
+    protected:
+        virtual long int getWindowEnd(int window_id) = 0; // user must define the end (exclusive) of a window, in the unit of the watermarks
+        virtual long int getAllowedLateness(); // how long a window accepts late events after its end, no late events by default
+        void fireWindows(vector<output_data>& res);
+        bool isWindowComplete(int window_id, const WindowInformation<T, A>& window);
+        bool isWindowExpired(int window_id, const WindowInformation<T, A>& window);
+        int getMaxCompleteness();
+
+    private:
+        pthread_mutex_t watermark_mtx;
+        long int scanned_watermark = NO_WATERMARK; // watermark of the last scan of the windows
+};
+
+template<typename T, typename A>
+WatermarkAggregator<T, A>::WatermarkAggregator(const int tag, const int rank, const int worldSize):
+CountAggregator<T, A>(tag, rank, worldSize)
+{
+    pthread_mutex_init(&watermark_mtx, NULL);
+}
+
+/**
+ * Same loop as the basic vertex, but the watermark of a message is only
+ * taken into account once its events are stored : otherwise a thread
+ * could output a window with the watermark of a message whose events
+ * are still being stored by another thread.
+ *
+ * The events are folded without the watermark lock (the windows have
+ * their own locks), so the channels only wait for each other to update
+ * the watermark and scan the complete windows.
+ * */
+template<typename T, typename A>
+void WatermarkAggregator<T, A>::streamProcess(int channel){
+
+    while (this->ALIVE) {
+        message_ptr message = this->fetchNextMessage(channel);
+        const long int watermark = MessageHeader::peek(message.get()).watermark;
+
+        // note : outputs the windows of the message that are already complete
+        vector<output_data> out = this->processMessage(move(message));
+
+        pthread_mutex_lock(&watermark_mtx);
+        this->updateWatermark(channel, watermark);
+        fireWindows(out);
+        pthread_mutex_unlock(&watermark_mtx);
+
+        this->send(move(out));
+    }
+}
+
+/**
+ * Outputs every window the watermark has passed : the watermark of a
+ * message may complete windows this message has no event for. The
+ * windows that are already fired output the delta of their late events
+ * when the watermark has moved, and are released once their lateness
+ * is over. Called with watermark_mtx locked.
+ * */
+template<typename T, typename A>
+void WatermarkAggregator<T, A>::fireWindows(vector<output_data>& res){
+
+    const long int watermark = this->getWatermark();
+    const bool advanced = watermark > scanned_watermark;
+    scanned_watermark = watermark;
+
+    // windows are output in the order of their ids
+    for (const long int window_id : this->windows.windowIDs()){
+        if (getWindowEnd(window_id) > watermark) break;
+
+        WindowInformation<T, A>* window = this->windows.find(window_id);
+        if (window == nullptr) continue;
+
+        const bool late_events = window->fired && window->accumulator.size() > 0;
+        const bool expired = isWindowExpired(window_id, *window);
+
+        if (!window->fired || (late_events && (advanced || expired))){
+            for (output_data& data : this->fireWindow(window_id, *window)){
+                res.push_back(move(data));
+            }
+        } else if (expired){
+            this->windows.release(window_id);
+        }
+
+        this->windows.unlock(window_id);
+    }
+}
+
+/**
+ * replaces isWindowComplete from count aggregator
+ * */
+template<typename T, typename A>
+bool WatermarkAggregator<T, A>::isWindowComplete(int window_id, const WindowInformation<T, A>&){
+    return getWindowEnd(window_id) <= this->getWatermark();
+}
+
+/**
+ * replaces isWindowExpired from count aggregator : the state of a window
+ * is kept until the watermark passes its end plus the allowed lateness.
+ * */
+template<typename T, typename A>
+bool WatermarkAggregator<T, A>::isWindowExpired(int window_id, const WindowInformation<T, A>&){
+    return getWindowEnd(window_id) + getAllowedLateness() <= this->getWatermark();
+}
+
+template<typename T, typename A>
+long int WatermarkAggregator<T, A>::getAllowedLateness(){
+    return 0;
+}
+
+/**
+ * Messages are not counted with this baseline.
+ * */
+template<typename T, typename A>
+int WatermarkAggregator<T, A>::getMaxCompleteness(){
+    return 0;
+}
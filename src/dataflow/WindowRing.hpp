@@ -0,0 +1,138 @@
+#pragma once
+#include "../communication/Window.hpp" // BUFFER_ALIGNMENT
+
+#include <vector>
+#include <algorithm> // sort
+#include <limits>
+#include <pthread.h>
+
+static const int WINDOW_SLOTS = 1024; // default number of windows that can be open at the same time
+
+/**
+ * Window states of type W stored in a ring of slots : window w lives in
+ * slot w mod capacity, each slot with its own mutex, so lookups don't
+ * search a tree and threads updating different windows don't wait for
+ * each other.
+ *
+ *     W* window = ring.lock(WID);
+ *     if (window != nullptr){
+ *         ... // only this window can be used
+ *         ring.unlock(WID);
+ *     }
+ *
+ * The id of the window stored in a slot is its epoch : a slot is reused
+ * by a newer window once it has been released, or when its window is
+ * capacity windows older than the new one (a window that never completed).
+ * Windows older than the one stored in their slot are too late, lock
+ * returns nullptr without locking anything.
+ *
+ * A thread must not lock two windows at the same time.
+ * */
+template<typename W>
+class WindowRing {
+
+    public:
+        explicit WindowRing(const int capacity = WINDOW_SLOTS);
+        ~WindowRing();
+
+        WindowRing(const WindowRing&) = delete;
+        WindowRing& operator=(const WindowRing&) = delete;
+
+        W* lock(const long int window_id); // creates the window if needed
+        W* find(const long int window_id); // nullptr if the window isn't stored
+        void unlock(const long int window_id);
+        void release(const long int window_id); // forgets the window, must be locked
+
+        std::vector<long int> windowIDs(); // stored windows, in order
+
+    private:
+        static const long int EMPTY = std::numeric_limits<long int>::min();
+
+        struct Slot {
+            pthread_mutex_t mutex;
+            long int window_id = EMPTY;
+            W state;
+            char padding[BUFFER_ALIGNMENT]; // keeps the mutexes on different cache lines
+        };
+
+        Slot& slot(const long int window_id);
+
+        std::vector<Slot> slots;
+};
+
+template<typename W>
+WindowRing<W>::WindowRing(const int capacity) :
+slots(capacity) {
+    for (Slot& slot : slots){
+        pthread_mutex_init(&slot.mutex, NULL);
+    }
+}
+
+template<typename W>
+WindowRing<W>::~WindowRing(){
+    for (Slot& slot : slots){
+        pthread_mutex_destroy(&slot.mutex);
+    }
+}
+
+template<typename W>
+typename WindowRing<W>::Slot& WindowRing<W>::slot(const long int window_id){
+    const long int index = window_id % (long int) slots.size();
+    return slots[index < 0 ? index + slots.size() : index];
+}
+
+template<typename W>
+W* WindowRing<W>::lock(const long int window_id){
+    Slot& s = slot(window_id);
+    pthread_mutex_lock(&s.mutex);
+
+    if (s.window_id != window_id){
+        if (s.window_id > window_id){
+            pthread_mutex_unlock(&s.mutex);
+            return nullptr;
+        }
+        s.window_id = window_id;
+        s.state = W();
+    }
+
+    return &s.state;
+}
+
+template<typename W>
+W* WindowRing<W>::find(const long int window_id){
+    Slot& s = slot(window_id);
+    pthread_mutex_lock(&s.mutex);
+
+    if (s.window_id != window_id){
+        pthread_mutex_unlock(&s.mutex);
+        return nullptr;
+    }
+
+    return &s.state;
+}
+
+template<typename W>
+void WindowRing<W>::unlock(const long int window_id){
+    pthread_mutex_unlock(&slot(window_id).mutex);
+}
+
+template<typename W>
+void WindowRing<W>::release(const long int window_id){
+    Slot& s = slot(window_id);
+    s.window_id = EMPTY;
+    s.state = W();
+}
+
+template<typename W>
+std::vector<long int> WindowRing<W>::windowIDs(){
+    std::vector<long int> res;
+
+    for (Slot& s : slots){
+        pthread_mutex_lock(&s.mutex);
+        if (s.window_id != EMPTY) res.push_back(s.window_id);
+        pthread_mutex_unlock(&s.mutex);
+    }
+
+    std::sort(res.begin(), res.end());
+    return res;
+}
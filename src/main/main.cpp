@@ -62,6 +62,8 @@
 #include "../usecases/SCB.hpp"
 #include "../usecases/SCBFW.hpp"
 #include "../usecases/SCBWS.hpp"
+#include "../usecases/SCBWM.hpp"
+#include "../nexmark_hot_items/CountBenchmark.hpp"
 
 using namespace std;
 using namespace nexmark;
@@ -138,6 +140,16 @@ int main(int argc, char* argv[]) {
 
 			dataflow = new scb_ws::SCBWS();
 		
+		} else if (s.compare("SCBWM") == 0) {
+
+			dataflow = new scb_wm::SCBWM();
+		
+		} else if (s.compare("NQ5COUNT") == 0) {
+
+			// microbenchmark, no dataflow
+			nexmark_hot_items::CountBenchmark::run(argc > 2 ? atoi(argv[2]) : 4);
+			return 0;
+
 		}
 
 	} else {
@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 2020 University of Luxembourg. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF LUXEMBOURG AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE UNIVERSITY OF LUXEMBOURG OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+/*
+ * AuctionCounts.hpp
+ */
+
+#pragma once
+
+#include <vector>
+#include <climits>
+#include <cstddef>
+#include <utility>
+
+using namespace std;
+
+namespace nexmark_hot_items {
+
+/**
+ * Flat open-addressing table of the bid counts per auction : counting a
+ * bid is a hash and a few probes in two arrays, without allocation (once
+ * the table has grown) and without tree rebalancing. Tables are not
+ * thread safe, each thread counts in its own tables and the tables are
+ * merged when a pane is complete.
+ * */
+class AuctionCounts {
+
+	public:
+	AuctionCounts(size_t capacity = 256); // power of 2
+
+	size_t& operator[](const int auction_id);
+	void add(const AuctionCounts& other); // merges the counts of another table
+
+	// calls f(auction_id, count) for every auction of the table
+	template<typename F>
+	void forEach(F f) const;
+
+	size_t size() const;
+	bool empty() const;
+
+	private:
+	static const int NO_AUCTION = INT_MIN;
+
+	vector<int> auction_ids;
+	vector<size_t> counts;
+	size_t nof_keys;
+
+	size_t slot(const int auction_id) const;
+	void rehash(size_t capacity);
+};
+
+inline AuctionCounts::AuctionCounts(size_t capacity) :
+auction_ids(capacity, (int) NO_AUCTION), counts(capacity, 0), nof_keys(0) {}
+
+inline size_t AuctionCounts::slot(const int auction_id) const {
+	size_t h = (size_t) auction_id * 0x9E3779B97F4A7C15ULL;
+	return (h ^ (h >> 29)) & (auction_ids.size() - 1);
+}
+
+inline size_t& AuctionCounts::operator[](const int auction_id){
+
+	if ((nof_keys + 1) * 2 > auction_ids.size())
+		rehash(auction_ids.size() * 2);
+
+	size_t i = slot(auction_id);
+
+	while (auction_ids[i] != NO_AUCTION) {
+		if (auction_ids[i] == auction_id)
+			return counts[i];
+		i = (i + 1) & (auction_ids.size() - 1);
+	}
+
+	auction_ids[i] = auction_id;
+	counts[i] = 0;
+	nof_keys++;
+	return counts[i];
+}
+
+inline void AuctionCounts::add(const AuctionCounts& other){
+	other.forEach([this](const int auction_id, const size_t count){
+		(*this)[auction_id] += count;
+	});
+}
+
+template<typename F>
+void AuctionCounts::forEach(F f) const {
+	for (size_t i = 0; i < auction_ids.size(); i++) {
+		if (auction_ids[i] != NO_AUCTION)
+			f(auction_ids[i], counts[i]);
+	}
+}
+
+inline size_t AuctionCounts::size() const {
+	return nof_keys;
+}
+
+inline bool AuctionCounts::empty() const {
+	return nof_keys == 0;
+}
+
+inline void AuctionCounts::rehash(size_t capacity){
+	AuctionCounts rehashed(capacity);
+	forEach([&rehashed](const int auction_id, const size_t count){
+		rehashed[auction_id] = count;
+	});
+	*this = std::move(rehashed);
+}
+};
\ No newline at end of file
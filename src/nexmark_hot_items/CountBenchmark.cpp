@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) 2020 University of Luxembourg. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF LUXEMBOURG AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE UNIVERSITY OF LUXEMBOURG OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+/*
+ * CountBenchmark.cpp
+ */
+
+#include "CountBenchmark.hpp"
+#include "AuctionCounts.hpp"
+
+#include <pthread.h>
+#include <chrono>
+#include <random>
+#include <map>
+#include <iostream>
+
+using nexmark_hot_items::CountBenchmark;
+using nexmark_hot_items::AuctionCounts;
+
+namespace {
+
+struct Shared {
+	map<int, size_t> counts;
+	pthread_mutex_t mutex;
+};
+
+struct Task {
+	const vector<int>* auction_ids;
+	Shared* shared; // nullptr : the thread counts in its own table
+	double counts_per_sec;
+};
+
+void* count(void* arg){
+	Task* task = (Task*) arg;
+	const vector<int>& auction_ids = *task->auction_ids;
+	AuctionCounts local;
+
+	auto start = chrono::steady_clock::now();
+
+	if (task->shared != nullptr){
+		for (const int auction_id : auction_ids){
+			pthread_mutex_lock(&task->shared->mutex);
+			task->shared->counts[auction_id]++;
+			pthread_mutex_unlock(&task->shared->mutex);
+		}
+	} else {
+		for (const int auction_id : auction_ids){
+			local[auction_id]++;
+		}
+	}
+
+	chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+	task->counts_per_sec = auction_ids.size() / elapsed.count();
+	return nullptr;
+}
+
+void runThreads(const char* name, vector<Task>& tasks){
+	vector<pthread_t> threads(tasks.size());
+
+	for (size_t t = 0; t < tasks.size(); t++)
+		pthread_create(&threads[t], NULL, count, &tasks[t]);
+
+	double total = 0;
+	for (size_t t = 0; t < tasks.size(); t++){
+		pthread_join(threads[t], NULL);
+		total += tasks[t].counts_per_sec;
+	}
+
+	cout << name << " | THREADS: " << tasks.size()
+		<< " | COUNTS/SEC PER THREAD: " << (long) (total / tasks.size())
+		<< " | TOTAL: " << (long) total << endl;
+}
+};
+
+void CountBenchmark::run(const int nof_threads, const size_t nof_bids, const int nof_auctions){
+
+	// same bids for both versions, a different sequence per thread
+	vector<vector<int>> auction_ids(nof_threads);
+	for (int t = 0; t < nof_threads; t++){
+		mt19937 generator(t);
+		uniform_int_distribution<int> auctions(0, nof_auctions - 1);
+
+		auction_ids[t].reserve(nof_bids);
+		for (size_t i = 0; i < nof_bids; i++)
+			auction_ids[t].push_back(auctions(generator));
+	}
+
+	Shared shared;
+	pthread_mutex_init(&shared.mutex, NULL);
+
+	vector<Task> locked, flat;
+	for (int t = 0; t < nof_threads; t++){
+		locked.push_back(Task{&auction_ids[t], &shared, 0});
+		flat.push_back(Task{&auction_ids[t], nullptr, 0});
+	}
+
+	runThreads("SHARED MAP", locked);
+	runThreads("FLAT TABLE PER THREAD", flat);
+
+	pthread_mutex_destroy(&shared.mutex);
+}
\ No newline at end of file
@@ -35,6 +35,7 @@
 #include "../usecases/NQ5.hpp"
 #include "../nexmark_gen/PODTypes.hpp"
 #include "../serialization/Serialization.hpp"
+#include "../output/ResultSink.hpp"
 
 #include <mpi.h>
 #include <unistd.h>
@@ -52,6 +53,7 @@ Vertex(tag, rank, worldSize),
 message_id(0),
 avg_latency(0.0) {	
 	pthread_mutex_init(&mutex, NULL);
+	pthread_mutex_init(&partial_windows_mutex, NULL);
 
 	S_CHECK(if (rank == 0){
 		datafile.open("NQ5.tsv");
@@ -75,7 +77,7 @@ void EventCollector::streamProcess(int channel) {
 			while (!tmpMessages->empty()) {
 
 				Message* inMessage = tmpMessages->front();
-				processInputMessage(inMessage);
+				processInputMessage(inMessage, channel);
 				tmpMessages->pop_front();
 				delete inMessage;
 			}
@@ -86,16 +88,85 @@ void EventCollector::streamProcess(int channel) {
 	}
 }
 
-void EventCollector::processInputMessage(Message*const inMessage){
-	int wid = Serialization::unwrap<int>(inMessage);
+void EventCollector::processInputMessage(Message*const inMessage, const int channel){
+	const MessageHeader& header = MessageHeader::peek(inMessage);
+	int wid = header.window_id;
 
 	vec auctions = getAuctions(inMessage);
+
+	if (header.flags & EARLY_RESULT){
+		const WrapperUnit unit = MessageHeader::readWrapperUnit(inMessage, 0);
+		const double completeness = (double) unit.completeness_tag_numerator / unit.completeness_tag_denominator;
+
+		// the collector has one channel per rank
+		const double window_completeness = mergeEarlyWindow(wid, channel % worldSize, completeness, auctions);
+
+		sortAuctionsByCount(auctions);
+		filterTopAuctions(auctions);
+
+		displayEarly(wid, window_completeness, auctions);
+		return;
+	}
+
+	if (!mergePartialWindow(wid, auctions)) return;
+
 	sortAuctionsByCount(auctions);
-	filterAuctionsWithMaxCount(auctions);
+	filterTopAuctions(auctions);
 
 	display(wid, auctions);
 }
 
+/**
+ * Every rank sends the top_k auctions it owns for each window, so the
+ * window has at most worldSize * top_k auctions (and ties) to sort.
+ * Returns true with the auctions of all the ranks once the last part
+ * of the window arrived.
+ * */
+bool EventCollector::mergePartialWindow(int wid, vec & auctions){
+	pthread_mutex_lock(&partial_windows_mutex);
+
+	PartialWindow& window = partial_windows[wid];
+	window.auctions.insert(window.auctions.end(), auctions.begin(), auctions.end());
+	window.nof_ranks++;
+
+	const bool is_complete = window.nof_ranks == worldSize;
+	if (is_complete){
+		auctions.swap(window.auctions);
+		partial_windows.erase(wid);
+		early_windows.erase(wid);
+	}
+
+	pthread_mutex_unlock(&partial_windows_mutex);
+	return is_complete;
+}
+
+/**
+ * Keeps the last early result of each rank for the window, and replaces
+ * the auctions with the ones of every rank : the ranks own different
+ * auctions. Returns the completeness of the window, the ranks that didn't
+ * send an early result yet count as empty.
+ * */
+double EventCollector::mergeEarlyWindow(int wid, int sender, double completeness, vec & auctions){
+	pthread_mutex_lock(&partial_windows_mutex);
+
+	EarlyWindow& window = early_windows[wid];
+	window.auctions[sender] = auctions;
+	window.completeness[sender] = completeness;
+
+	auctions.clear();
+	for (auto& part : window.auctions){
+		auctions.insert(auctions.end(), part.second.begin(), part.second.end());
+	}
+
+	double res = 0;
+	for (auto& part : window.completeness){
+		res += part.second;
+	}
+
+	pthread_mutex_unlock(&partial_windows_mutex);
+	return res / worldSize;
+}
+
 void EventCollector::fetchInputMessages(list<Message*>* tmpMessages, const int channel){
 	pthread_mutex_lock(&listenerMutexes[channel]);
 
@@ -111,10 +182,13 @@ void EventCollector::fetchInputMessages(list<Message*>* tmpMessages, const int c
 	pthread_mutex_unlock(&listenerMutexes[channel]);
 }
 
-void EventCollector::filterAuctionsWithMaxCount(vec & auctions){
-	// remove auctions for which nof_bids isn't the max
-	vec::iterator iter = remove_if(auctions.begin(), auctions.end(), [&auctions](pair<int, size_t> & a){
-		return a.second < auctions[0].second;
+void EventCollector::filterTopAuctions(vec & auctions){
+	if (auctions.size() <= nexmark::NQ5::top_k) return;
+
+	// remove auctions for which nof_bids is below the k-th count
+	const size_t min_count = auctions[nexmark::NQ5::top_k - 1].second;
+	vec::iterator iter = remove_if(auctions.begin(), auctions.end(), [min_count](pair<int, size_t> & a){
+		return a.second < min_count;
 	});
 	auctions.erase(iter, auctions.end());
 }
@@ -129,13 +203,14 @@ void EventCollector::sortAuctionsByCount(vec & auctions){
 vec EventCollector::getAuctions(const Message* const message){
 
 	size_t pair_size = sizeof(int) + sizeof(size_t);
-	int nof_auctions = message->size / pair_size;
+	size_t offset = MessageHeader::peek(message).payloadOffset();
+	int nof_auctions = (message->size - offset) / pair_size;
 
 	vec auctions; auctions.reserve(nof_auctions);
 	for (size_t i = 0; i < nof_auctions; i++)
 	{
-		const int auction_id = Serialization::read_front<int>(message, pair_size * i);
-		const size_t nof_bids = Serialization::read_front<size_t>(message, pair_size * i + sizeof(int));
+		const int auction_id = Serialization::read_front<int>(message, offset + pair_size * i);
+		const size_t nof_bids = Serialization::read_front<size_t>(message, offset + pair_size * i + sizeof(int));
 		auctions.push_back(pair<int, size_t>(auction_id, nof_bids));
 	}
 
@@ -161,7 +236,9 @@ void EventCollector::display(int wid, vec & auctions){
 	avg_latency = (avg_latency * message_id + latency ) / (message_id + 1);
 
 	// cout << "(WID)" << wid << " " << message_id << ", " << latency << ", " << avg_latency << "\n";
-	cout << "NQ5 (count), " << worldSize << ", " << wid << ", " << latency << ", " << avg_latency << "\n";
+	stringstream line;
+	line << "NQ5 (count), " << worldSize << ", " << wid << ", " << latency << ", " << avg_latency << "\n";
+	ResultSink::console().print(line.str());
 
 	
 	for (size_t i = 0; i < auctions.size(); i++)
@@ -176,3 +253,18 @@ void EventCollector::display(int wid, vec & auctions){
 	pthread_mutex_unlock(&mutex);
 
 }
+
+/**
+ * Early results are only displayed, the data file holds the final results.
+ * */
+void EventCollector::displayEarly(int wid, double completeness, vec & auctions){
+	stringstream line;
+	line << "NQ5 (early), " << worldSize << ", " << wid << ", " << completeness;
+	for (size_t i = 0; i < auctions.size(); i++)
+	{
+		line << ", " << auctions[i].first << ":" << auctions[i].second;
+	}
+	line << "\n";
+
+	ResultSink::console().print(line.str());
+}
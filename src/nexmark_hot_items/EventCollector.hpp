@@ -34,6 +34,7 @@
 #pragma once
 #include "../dataflow/Vertex.hpp"
 #include <fstream>
+#include <map>
 
 namespace nexmark_hot_items {
 
@@ -48,17 +49,33 @@ class EventCollector: public Vertex {
 
 	protected:
 	virtual void fetchInputMessages(list<Message*>* tmpMessages, const int channel);
-	virtual void processInputMessage(Message*const message);
+	virtual void processInputMessage(Message*const message, const int channel);
+	virtual bool mergePartialWindow(int wid, vec & auctions);
+	virtual double mergeEarlyWindow(int wid, int sender, double completeness, vec & auctions);
 	virtual void display(int wid, vec & auctions);
+	virtual void displayEarly(int wid, double completeness, vec & auctions);
 	virtual vec getAuctions(const Message* const inMessage);
 	virtual void sortAuctionsByCount(vec & auctions);
-	virtual void filterAuctionsWithMaxCount(vec & auctions);
+	virtual void filterTopAuctions(vec & auctions);
 
 	private:
 	int message_id;
 	pthread_mutex_t mutex;
 	double avg_latency;
 
+	struct PartialWindow {
+		vec auctions;
+		int nof_ranks = 0;
+	};
+	map<int, PartialWindow> partial_windows; // one part per rank
+
+	struct EarlyWindow {
+		map<int, vec> auctions; // last early result of each rank
+		map<int, double> completeness;
+	};
+	map<int, EarlyWindow> early_windows; // uses partial_windows_mutex
+	pthread_mutex_t partial_windows_mutex;
+
 	std::ofstream datafile; // for sanity checks
 };
 };
\ No newline at end of file
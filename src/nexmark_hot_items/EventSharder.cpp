@@ -77,8 +77,9 @@ void EventSharder::processInputMessage(Message*const inMessage){
     int message_id = Serialization::unwrap<int>(inMessage);
 
     ShardedMessage shards;
-    shardEvents(shards, inMessage);
-    send(shards, message_id);
+    const int pane = shardPane(shards, inMessage);
+
+    if (pane >= 0) sendPane(shards, pane, message_id);
 }
 
 void EventSharder::fetchInputMessages(list<Message*>* tmpMessages, const int channel){
@@ -96,6 +97,32 @@ void EventSharder::fetchInputMessages(list<Message*>* tmpMessages, const int cha
 	pthread_mutex_unlock(&listenerMutexes[channel]);
 }
 
+/**
+ * Windows are built from panes of window_shift seconds : each bid belongs
+ * to exactly one pane, and is sent once to the rank owning its auction
+ * (instead of being copied in the window_duration / window_shift windows
+ * it belongs to).
+ *
+ * A message of the generator spans 1 / PER_SEC_MSG_COUNT second, so all
+ * its bids are given the pane of the first one : the ranks can count the
+ * messages of a pane. Returns the pane, or -1 if there is no bid.
+ * */
+int EventSharder::shardPane(ShardedMessage& shards, Message*const inMessage){
+    int nof_bids = inMessage->size / sizeof(Bid);
+
+    if (nof_bids == 0) return -1;
+
+	for (size_t i = 0; i < nof_bids; i++)
+	{
+		const Bid& bid = Serialization::read_front<Bid>(inMessage, sizeof(Bid) * i);
+        shards[bid.auction_id % worldSize].push_back(bid); // copy bid
+	}
+
+    const Bid& first_bid = Serialization::read_front<Bid>(inMessage, 0);
+    return first_bid.event_time / nexmark::NQ5::window_shift;
+}
+
+// copies each bid in every window it belongs to (used by NQ5WS)
 void EventSharder::shardEvents(ShardedMessage& shards, Message*const inMessage){
     int nof_bids = inMessage->size / sizeof(Bid);
 
@@ -119,6 +146,23 @@ void EventSharder::shardEvents(ShardedMessage& shards, Message*const inMessage){
 }
 
 
+// sends one message to every rank, even without bids, so that every rank
+// gets the same number of messages per pane
+void EventSharder::sendPane(ShardedMessage &shards, const int pane, const int message_id){
+
+    msgid_min_wid = pane;
+    msgid_max_wid = pane;
+
+    for (int targeted_rank = 0; targeted_rank < worldSize; targeted_rank++)
+    {
+        send(shards[targeted_rank], targeted_rank, pane, message_id);
+    }
+
+    // reset min & max wids
+    msgid_min_wid = numeric_limits<int>::max();
+    msgid_max_wid = 0;
+}
+
 // sends each message to the corresponding rank
 void EventSharder::send(ShardedMessage &shards, const int message_id){
 
@@ -141,17 +185,21 @@ void EventSharder::send(ShardedMessage &shards, const int message_id){
 // we just pass the address of the message we wish to send, no modification intended
 void EventSharder::send(const vector<Bid> & events, const int channel, const int wid, const int message_id){
 
-    Message* outMessage = new Message(sizeof(Bid) * events.size() + sizeof(int) + sizeof(int) + 2*sizeof(int));
+    Message* outMessage = new Message(MessageHeader::length(0) + sizeof(Bid) * events.size());
+
+    MessageHeader header;
+    header.message_id = message_id;
+    header.window_id = wid;
+    header.min_wid = msgid_min_wid;
+    header.max_wid = msgid_max_wid; // helps to make sure we'll get messages in order
+    MessageHeader::write(header, outMessage);
+    outMessage->size = header.payloadOffset();
+
     for (size_t i = 0; i < events.size(); i++)
     {
         Serialization::wrap<Bid>(events[i], outMessage);
     }
 
-    Serialization::wrap<int>(msgid_min_wid, outMessage);
-    Serialization::wrap<int>(msgid_max_wid, outMessage); // helps to make sure we'll get messages in order
-    Serialization::wrap<int>(wid, outMessage);
-    Serialization::wrap<int>(message_id, outMessage);
-
     send(outMessage, channel);
 }
 
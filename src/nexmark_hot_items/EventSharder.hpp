@@ -51,7 +51,9 @@ typedef unordered_map<int, vector<Bid>> ShardedMessage;
 	protected:
 	virtual void fetchInputMessages(list<Message*>* tmpMessages, const int channel);
 	virtual void processInputMessage(Message*const message);
-	virtual void shardEvents(ShardedMessage& shards, Message*const inMessage);
+	virtual int shardPane(ShardedMessage& shards, Message*const inMessage); // one shard per rank
+	virtual void shardEvents(ShardedMessage& shards, Message*const inMessage); // one shard per window
+	virtual void sendPane(ShardedMessage &shards, const int pane, const int message_id);
     virtual void send(ShardedMessage &shards, const int message_id);
 	virtual void send(const vector<Bid> & events, const int channel, const int wid, const int message_id);
 	virtual void send(Message*const message, const int channel);
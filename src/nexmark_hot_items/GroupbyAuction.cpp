@@ -49,15 +49,21 @@ using nexmark_gen::Bid;
 using std::min;
 
 GroupbyAuction::GroupbyAuction(int tag, int rank, int worldSize) :
-Vertex(tag, rank, worldSize) {
+Vertex(tag, rank, worldSize),
+next_pane(-1),
+early_timers((long int) (MPI_Wtime() * 1000)),
+early_window(-1),
+nof_messages_since_early(0) {
 	pthread_mutex_init(&windows_mutex, NULL);
 	pthread_mutex_init(&completeness_mutex, NULL);
+	pthread_mutex_init(&panes_mutex, NULL);
 }
 
 void GroupbyAuction::streamProcess(int channel) {
 
 	// one instance per thread (i.e. for one rank, we have rank threads)
 	list<Message*>* tmpMessages = new list<Message*>();
+	ChannelCounts& local = getChannelCounts(channel);
 	
 	while (ALIVE) {
 
@@ -68,7 +74,7 @@ void GroupbyAuction::streamProcess(int channel) {
 			while (!tmpMessages->empty()) {
 
 				Message* inMessage = tmpMessages->front();
-				processInputMessage(inMessage);
+				processInputMessage(inMessage, local);
 				tmpMessages->pop_front();
 				delete inMessage;
 			}
@@ -77,21 +83,226 @@ void GroupbyAuction::streamProcess(int channel) {
 	delete tmpMessages;
 }
 
-void GroupbyAuction::processInputMessage(Message*const message){
-	int wid = Serialization::read_back<int>(message, sizeof(int));
+// references to the elements of a map stay valid
+GroupbyAuction::ChannelCounts& GroupbyAuction::getChannelCounts(const int channel){
+	pthread_mutex_lock(&panes_mutex);
+	ChannelCounts& local = channel_counts[channel];
+	pthread_mutex_unlock(&panes_mutex);
+
+	return local;
+}
+
+/**
+ * Counts the bids of the message in the table of its pane for this channel,
+ * the other threads don't use it. A pane is complete once every event
+ * sharder sent all its messages for the pane (one per input message), the
+ * panes only take the shared lock once per message.
+ * */
+void GroupbyAuction::processInputMessage(Message*const message, ChannelCounts & local){
+	const MessageHeader header = MessageHeader::read(message);
+	const int pane_id = header.window_id;
+
+	const size_t offset = header.payloadOffset();
+	size_t nof_bids = (message->size - offset) / sizeof(Bid);
+
+	pthread_mutex_lock(&local.mutex);
+	AuctionBids& bids = local.panes[pane_id];
+	for(size_t i = 0; i < nof_bids; i++){
+		const Bid& bid = Serialization::read_front<Bid>(message, offset + sizeof(Bid) * i);
+		bids[bid.auction_id]++;
+	}
+	pthread_mutex_unlock(&local.mutex);
+
+	pthread_mutex_lock(&panes_mutex);
+
+	// the panes started before the first complete one are dropped
+	// (their counts are removed with the next merge)
+	if (next_pane >= 0 && pane_id < next_pane){
+		pthread_mutex_unlock(&panes_mutex);
+		return;
+	}
+
+	Pane& pane = panes[pane_id];
+	pane.nof_messages++;
+
+	const int window_shift = nexmark::NQ5::window_shift;
+	if (pane.nof_messages == PER_SEC_MSG_COUNT * window_shift * worldSize){
+		if (next_pane < 0){
+			next_pane = pane_id;
+			panes.erase(panes.begin(), panes.find(pane_id));
+		}
+		mergePane(pane_id, pane);
+		slide();
+	}
+
+	fireEarly();
+
+	pthread_mutex_unlock(&panes_mutex);
+}
+
+/**
+ * Merges the counts of every channel for a complete pane. The older panes
+ * of the channels may still be incomplete (panes can complete out of
+ * order), only the ones before next_pane are dropped : they were merged
+ * already or started before the first complete pane. Must be called with
+ * panes_mutex locked.
+ * */
+void GroupbyAuction::mergePane(const int pane_id, Pane & pane){
+	for (auto& channel : channel_counts){
+		ChannelCounts& local = channel.second;
+
+		pthread_mutex_lock(&local.mutex);
+		auto counts = local.panes.find(pane_id);
+		if (counts != local.panes.end()){
+			pane.bids.add(counts->second);
+			local.panes.erase(counts);
+		}
+		local.panes.erase(local.panes.begin(), local.panes.lower_bound(next_pane));
+		pthread_mutex_unlock(&local.mutex);
+	}
+}
+
+/**
+ * Adds the complete panes to the window in order. Once the window holds
+ * window_duration / window_shift panes it is sent, then its first pane is
+ * subtracted and evicted : the state and the work per pane don't depend on
+ * the number of windows a bid belongs to.
+ *
+ * Each rank owns a subset of the auctions, so only its top_k auctions are
+ * sent. Must be called with panes_mutex locked.
+ * */
+void GroupbyAuction::slide(){
+	const int window_shift = nexmark::NQ5::window_shift;
+	const int panes_per_window = nexmark::NQ5::window_duration / window_shift;
+	const int pane_messages = PER_SEC_MSG_COUNT * window_shift * worldSize;
+
+	while (true){
+		auto pane = panes.find(next_pane);
+		if (pane == panes.end() || pane->second.nof_messages < pane_messages) break;
+
+		pane->second.bids.forEach([this](const int auction_id, const size_t count){
+			window_bids.add(auction_id, count);
+		});
+		next_pane++;
+
+		const int wid = panes.begin()->first;
+		if (next_pane - wid < panes_per_window) continue;
+
+		send(wid, window_bids.top(nexmark::NQ5::top_k));
+
+		// subtract-on-evict
+		panes.begin()->second.bids.forEach([this](const int auction_id, const size_t count){
+			window_bids.add(auction_id, - (long int) count);
+		});
+		panes.erase(panes.begin());
+	}
+}
+
+/**
+ * Sends an early result of the next window to complete when its timer
+ * expires or after early_firing_messages input messages, cf. NQ5. The
+ * timers are driven by the input messages, and the timer of a window
+ * that has been sent is ignored. Must be called with panes_mutex locked.
+ * */
+void GroupbyAuction::fireEarly(){
+	const int period = nexmark::NQ5::early_firing_period * 1000;
+	const int nof_messages = nexmark::NQ5::early_firing_messages;
+
+	nof_messages_since_early++;
+	if (next_pane < 0 || panes.empty()) return; // windows start with the first complete pane
+
+	const int wid = panes.begin()->first;
+	bool fire = nof_messages > 0 && nof_messages_since_early >= nof_messages;
+
+	if (period > 0){
+		const long int now = (long int) (MPI_Wtime() * 1000);
+
+		if (wid != early_window){
+			early_window = wid;
+			early_timers.schedule(now + period, wid);
+		}
+
+		for (const int window_id : early_timers.advance(now)){
+			if (window_id != wid) continue;
+			fire = true;
+			early_timers.schedule(now + period, wid);
+		}
+	}
+
+	if (fire){
+		nof_messages_since_early = 0;
+		sendEarly(wid);
+	}
+}
+
+/**
+ * The early result of a window adds the bids of its incomplete panes, still
+ * in the tables of the channels, to the complete panes of window_bids. Only
+ * the auctions of the incomplete panes can move past the top_k of
+ * window_bids, so the top_k of the window is found among them and the
+ * top_k of window_bids. Must be called with panes_mutex locked.
+ * */
+void GroupbyAuction::sendEarly(const int wid){
+	const int window_shift = nexmark::NQ5::window_shift;
+	const int panes_per_window = nexmark::NQ5::window_duration / window_shift;
+	const int pane_messages = PER_SEC_MSG_COUNT * window_shift * worldSize;
+	const int window_end = wid + panes_per_window; // first pane after the window
+
+	AuctionBids partial;
+	for (auto& channel : channel_counts){
+		ChannelCounts& local = channel.second;
+
+		pthread_mutex_lock(&local.mutex);
+		auto last = local.panes.lower_bound(window_end);
+		for (auto it = local.panes.lower_bound(next_pane); it != last; ++it){
+			partial.add(it->second);
+		}
+		pthread_mutex_unlock(&local.mutex);
+	}
+
+	AuctionBids candidates;
+	for (const pair<int, size_t>& auction : window_bids.top(nexmark::NQ5::top_k)){
+		candidates[auction.first] = auction.second;
+	}
+	partial.forEach([this, &candidates](const int auction_id, const size_t count){
+		candidates[auction_id] = window_bids.count(auction_id) + count;
+	});
+
+	HotItems early;
+	candidates.forEach([&early](const int auction_id, const size_t count){
+		early.add(auction_id, count);
+	});
+
+	// messages received for the window, out of the messages of its panes
+	WrapperUnit completeness;
+	completeness.window_start_time = wid * window_shift;
+	completeness.completeness_tag_numerator = (next_pane - wid) * pane_messages;
+	completeness.completeness_tag_denominator = panes_per_window * pane_messages;
+	for (auto it = panes.lower_bound(next_pane); it != panes.end() && it->first < window_end; ++it){
+		completeness.completeness_tag_numerator += it->second.nof_messages;
+	}
+
+	send(wid, early.top(nexmark::NQ5::top_k), completeness, EARLY_RESULT);
+}
+
+void GroupbyAuction::processWindowMessage(Message*const message){
+	const MessageHeader header = MessageHeader::read(message);
+	int wid = header.window_id;
 	
 	// count nof bids per auction for the given window data, and update current count
-	int header_size = 4*sizeof(int);
-	size_t nof_bids = (message->size - header_size) / sizeof(Bid);
+	const size_t offset = header.payloadOffset();
+	size_t nof_bids = (message->size - offset) / sizeof(Bid);
 
+	AuctionBids bids;
 	for(size_t i = 0; i < nof_bids; i++){
-		const Bid& bid = Serialization::read_front<Bid>(message, sizeof(Bid) * i);
-
-		pthread_mutex_lock(&windows_mutex);
-		windows[wid][bid.auction_id]++;
-		pthread_mutex_unlock(&windows_mutex);
+		const Bid& bid = Serialization::read_front<Bid>(message, offset + sizeof(Bid) * i);
+		bids[bid.auction_id]++;
 	}
 
+	pthread_mutex_lock(&windows_mutex);
+	windows[wid].add(bids);
+	pthread_mutex_unlock(&windows_mutex);
+
 	// update completeness information
 	pthread_mutex_lock(&completeness_mutex);
 	completeness.emplace(wid, 0);
@@ -124,17 +335,44 @@ void GroupbyAuction::fetchInputMessages(list<Message*>* tmpMessages, const int c
 }
 
 void GroupbyAuction::send(int wid){
+	send(wid, windows[wid]);
+}
+
+void GroupbyAuction::send(int wid, const AuctionBids & bids){
+	vector<pair<int, size_t>> auctions; auctions.reserve(bids.size());
+	bids.forEach([&auctions](const int auction_id, const size_t count){
+		auctions.push_back(pair<int, size_t>(auction_id, count));
+	});
+	send(wid, auctions);
+}
 
-	// message = window id + list of counts per auction
-	Message* outMessage = new Message(sizeof(int) + windows[wid].size() * (sizeof(int) + sizeof(size_t)));
+void GroupbyAuction::send(int wid, const vector<pair<int, size_t>> & bids){
+	WrapperUnit completeness;
+	completeness.window_start_time = wid * nexmark::NQ5::window_shift;
+	completeness.completeness_tag_numerator = 1;
+	completeness.completeness_tag_denominator = 1; // every event of the window has been counted
+
+	send(wid, bids, completeness, 0);
+}
+
+void GroupbyAuction::send(int wid, const vector<pair<int, size_t>> & bids, const WrapperUnit & completeness, const uint8_t flags){
+
+	// message = header (window id, completeness of the window) + list of counts per auction
+	Message* outMessage = new Message(MessageHeader::length(1) + bids.size() * (sizeof(int) + sizeof(size_t)));
+
+	MessageHeader header;
+	header.window_id = wid;
+	header.flags = flags;
+	header.nof_wrapper_units = 1;
+	MessageHeader::write(header, outMessage);
+	MessageHeader::writeWrapperUnit(completeness, 0, outMessage);
+	outMessage->size = header.payloadOffset();
 	
-	for(auto it = windows[wid].begin(); it != windows[wid].end(); ++it){
+	for(auto it = bids.begin(); it != bids.end(); ++it){
 		Serialization::wrap<int>((*it).first, outMessage); // auction_id
 		Serialization::wrap<size_t>((*it).second, outMessage); // nof bids for the given auction
 	}
 
-	Serialization::wrap<int>(wid, outMessage);
-
 	// send to the global aggregator on rank 0
 	send(outMessage, 0);
 }
@@ -33,6 +33,9 @@
 
 #pragma once
 #include "../dataflow/Vertex.hpp"
+#include "HotItems.hpp"
+#include "AuctionCounts.hpp"
+#include "../dataflow/TimingWheel.hpp"
 
 #include <map>
 
@@ -40,18 +43,40 @@ namespace nexmark_hot_items {
 
 class GroupbyAuction: public Vertex {
 
-	typedef map<int, size_t> AuctionBids; // windows[wid][auction_id]
+	typedef AuctionCounts AuctionBids; // windows[wid][auction_id]
 	typedef map<int, AuctionBids> Windows;
 
+	struct Pane {
+		AuctionBids bids; // merged once the pane is complete
+		int nof_messages = 0;
+	};
+	typedef map<int, Pane> Panes;
+
+	// the bids counted by the thread of a channel, per pane
+	struct ChannelCounts {
+		map<int, AuctionBids> panes;
+		pthread_mutex_t mutex; // only contended when a pane is merged
+		ChannelCounts(){pthread_mutex_init(&mutex, NULL);};
+	};
+
 	public:
 	GroupbyAuction(int tag, int rank, int worldSize);
 	void streamProcess(int channel);
 	void update(int wid, Message*const inMessage);
 	void send(int wid);
+	void send(int wid, const AuctionBids & bids);
+	void send(int wid, const vector<pair<int, size_t>> & auctions); // final result
+	void send(int wid, const vector<pair<int, size_t>> & auctions, const WrapperUnit & completeness, const uint8_t flags);
 
 	protected:
 	virtual void fetchInputMessages(list<Message*>* tmpMessages, const int channel);
-	virtual void processInputMessage(Message*const message);
+	virtual void processInputMessage(Message*const message, ChannelCounts & local); // pane based
+	virtual void processWindowMessage(Message*const message); // window based, cf. NQ5WS
+	virtual void mergePane(const int pane_id, Pane & pane);
+	virtual void slide();
+	virtual void fireEarly();
+	virtual void sendEarly(const int wid);
+	ChannelCounts & getChannelCounts(const int channel);
 	virtual void send(Message*const message, const int channel);
 
 	private:
@@ -60,5 +85,16 @@ class GroupbyAuction: public Vertex {
 
 	map<int, int> completeness;
 	pthread_mutex_t completeness_mutex;
+
+	Panes panes; // panes before next_pane are summed in window_bids
+	HotItems window_bids;
+	int next_pane;
+	pthread_mutex_t panes_mutex;
+
+	map<int, ChannelCounts> channel_counts; // one per channel
+
+	TimingWheel<int> early_timers; // early firing of the windows, ticks are milliseconds
+	int early_window; // window with an early firing timer
+	int nof_messages_since_early; // input messages since the last early result
 };
 };
\ No newline at end of file
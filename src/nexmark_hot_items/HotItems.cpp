@@ -0,0 +1,74 @@
+/**
+ * Copyright (c) 2020 University of Luxembourg. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF LUXEMBOURG AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE UNIVERSITY OF LUXEMBOURG OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+/*
+ * HotItems.cpp
+ */
+
+#include "HotItems.hpp"
+
+using nexmark_hot_items::HotItems;
+
+void HotItems::add(const int auction_id, const long int nof_bids){
+	if (nof_bids == 0) return;
+
+	size_t& count = counts[auction_id];
+
+	if (count > 0){
+		auto bucket = auctions_by_count.find(count);
+		bucket->second.erase(auction_id);
+		if (bucket->second.empty()) auctions_by_count.erase(bucket);
+	}
+
+	count += nof_bids;
+
+	if (count == 0){
+		counts.erase(auction_id);
+	} else {
+		auctions_by_count[count].insert(auction_id);
+	}
+}
+
+size_t HotItems::size() const {
+	return counts.size();
+}
+
+size_t HotItems::count(const int auction_id) const {
+	auto it = counts.find(auction_id);
+	return it == counts.end() ? 0 : it->second;
+}
+
+vector<pair<int, size_t>> HotItems::top(const size_t k) const {
+	vector<pair<int, size_t>> auctions;
+
+	for (auto bucket = auctions_by_count.begin(); bucket != auctions_by_count.end() && auctions.size() < k; ++bucket){
+		for (const int auction_id : bucket->second){
+			auctions.push_back(pair<int, size_t>(auction_id, bucket->first));
+		}
+	}
+
+	return auctions;
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2020 University of Luxembourg. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF LUXEMBOURG AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE UNIVERSITY OF LUXEMBOURG OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+/*
+ * HotItems.hpp
+ */
+
+#pragma once
+
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <functional>
+
+using namespace std;
+
+namespace nexmark_hot_items {
+
+/**
+ * Bid counts of the auctions of a window, also indexed by count : the k
+ * hottest auctions are read from the highest counts, without looking at
+ * the other auctions. Counts can go down, when a pane leaves the window.
+ * */
+class HotItems {
+
+	typedef unordered_map<int, size_t> Counts; // counts[auction_id]
+	typedef map<size_t, unordered_set<int>, greater<size_t>> AuctionsByCount;
+
+	public:
+	void add(const int auction_id, const long int nof_bids); // nof_bids may be negative
+	size_t size() const;
+	size_t count(const int auction_id) const; // 0 for the auctions without bids
+
+	// the k auctions with the highest counts, and the ones tied with the k-th
+	vector<pair<int, size_t>> top(const size_t k) const;
+
+	private:
+	Counts counts;
+	AuctionsByCount auctions_by_count;
+};
+};
\ No newline at end of file
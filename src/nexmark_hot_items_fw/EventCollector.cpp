@@ -35,6 +35,7 @@
 #include "../nexmark_gen/PODTypes.hpp"
 #include "../usecases/NQ5FW.hpp"
 #include "../serialization/Serialization.hpp"
+#include "../output/ResultSink.hpp"
 
 #include <mpi.h>
 #include <unistd.h>
@@ -152,7 +153,9 @@ void EventCollector::debug(Message*const message, int message_id = 0){
 	// {
 	// 	cout << auctions[i].first << " : " << auctions[i].second << "\n";
 	// } cout << endl;
-	cout << "NQ5 (flow-wrapping), " << worldSize << ", " << wid << ", " << latency << ", " << avg_latency << "\n";
+	stringstream line;
+	line << "NQ5 (flow-wrapping), " << worldSize << ", " << wid << ", " << latency << ", " << avg_latency << "\n";
+	ResultSink::console().print(line.str());
 
 	for (size_t i = 0; i < auctions.size(); i++)
 	{
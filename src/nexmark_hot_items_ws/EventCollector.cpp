@@ -35,6 +35,7 @@
 #include "../nexmark_gen/PODTypes.hpp"
 #include "../usecases/NQ5WS.hpp"
 #include "../serialization/Serialization.hpp"
+#include "../output/ResultSink.hpp"
 
 #include <mpi.h>
 #include <unistd.h>
@@ -94,7 +95,7 @@ void EventCollector::streamProcess(int channel) {
 				inMessage = tmpMessages->front();
 				tmpMessages->pop_front();
 
-				int wid = Serialization::unwrap<int>(inMessage);
+				int wid = MessageHeader::peek(inMessage).window_id;
 
 				vec auctions = getAuctions(inMessage);
 				sortAuctionsByCount(auctions);
@@ -130,13 +131,14 @@ void EventCollector::sortAuctionsByCount(vec & auctions){
 vec EventCollector::getAuctions(const Message* const message){
 
 	size_t pair_size = sizeof(int) + sizeof(size_t);
-	int nof_auctions = message->size / pair_size;
+	size_t offset = MessageHeader::peek(message).payloadOffset();
+	int nof_auctions = (message->size - offset) / pair_size;
 
 	vec auctions; auctions.reserve(nof_auctions);
 	for (size_t i = 0; i < nof_auctions; i++)
 	{
-		const int auction_id = Serialization::read_front<int>(message, pair_size * i);
-		const size_t nof_bids = Serialization::read_front<size_t>(message, pair_size * i + sizeof(int));
+		const int auction_id = Serialization::read_front<int>(message, offset + pair_size * i);
+		const size_t nof_bids = Serialization::read_front<size_t>(message, offset + pair_size * i + sizeof(int));
 		auctions.push_back(pair<int, size_t>(auction_id, nof_bids));
 	}
 
@@ -162,7 +164,9 @@ void EventCollector::debug(int wid, vec & auctions){
 	avg_latency = (avg_latency * message_id + latency ) / (message_id + 1);
 
 	// cout << "(WID)" << wid << " " << message_id << ", " << latency << ", " << avg_latency << "\n";
-	cout << "NQ5 (sort), " << worldSize << ", " << wid << ", " << latency << ", " << avg_latency << "\n";
+	stringstream line;
+	line << "NQ5 (sort), " << worldSize << ", " << wid << ", " << latency << ", " << avg_latency << "\n";
+	ResultSink::console().print(line.str());
 
 	for (size_t i = 0; i < auctions.size(); i++)
 	{
@@ -56,6 +56,7 @@ void GroupbyAuction::streamProcess(int channel) {
 	// one instance per thread (i.e. for one rank, we have rank threads)
 	Message* inMessage;
 	list<Message*>* tmpMessages = new list<Message*>();
+	Buffer messages;
 	int expected_msgid;
 	int expected_wid;
 	bool is_first_time = true;
@@ -70,42 +71,37 @@ void GroupbyAuction::streamProcess(int channel) {
 
 			// process events in order (makes sure windows really are finished
 			// when we test if they are complete)
-			sortMessages(tmpMessages);
+			bufferMessages(tmpMessages, messages);
 
 			// the first time the thread arrives here, we don't know what rank it comes from
 			// this method reads the first message id to determine that, and the thread will
 			// continue to process messages from this rank
-			initExpectedMID(tmpMessages->front(), expected_msgid, is_first_time);
+			initExpectedMID(messages.front(), expected_msgid, is_first_time);
 			
 			// once we know the msgid we start from, we can determine what wids we will be 
 			// confronted to. The min and max wid values are stored int every messages and
 			// are unique to each message id.
-			initExpectedWID(tmpMessages->front(), expected_msgid, expected_wid, is_expected_msgid_being_processed);
+			initExpectedWID(messages.front(), expected_msgid, expected_wid, is_expected_msgid_being_processed);
 
 			// as messages are sorted, process as many as we possibly can
 			// if the msgid or wid is not expected, wait for other messages to come in
 			// that much is also true if there are no more messages to read from the list
-			while (!tmpMessages->empty() && isMessageExpected(tmpMessages->front(), expected_msgid, expected_wid)) {
+			while (!messages.empty() && isMessageExpected(messages.front(), expected_msgid, expected_wid)) {
 
 				// inMessage = header + list of bids
 				// with msgid = sharder rank + n * worldSize (odd or even if worldSize == 2)
 				// note that msgid is not global, it is dependent on the current thread's origin (i.e. event sharder)
 				// and wid depends on current operator rank (odd or even is worldSize == 2)
-				inMessage = tmpMessages->front();
-				tmpMessages->pop_front(); 
+				inMessage = messages.pop();
 
-				// header = msgid + wid + max_wid + min_wid
-				int wid = Serialization::read_back<int>(inMessage, sizeof(int));
-				int min_wid = Serialization::read_back<int>(inMessage, sizeof(int)*3);
-
-				OriginalGroupbyAuction::processInputMessage(inMessage);
+				OriginalGroupbyAuction::processWindowMessage(inMessage);
 
 				// once the current message has been processed, we need to know if
 				// we can process the next one, i.e. we need to determine what msgid
 				// and wid values we expect to find in the next message.
 				// 
 				// note : we expect different values for every thread.
-				updateExpectedValues(inMessage, tmpMessages, expected_msgid, expected_wid, is_expected_msgid_being_processed);
+				updateExpectedValues(inMessage, messages, expected_msgid, expected_wid, is_expected_msgid_being_processed);
 
 				delete inMessage; // delete message from incoming queue
 			}
@@ -115,11 +111,11 @@ void GroupbyAuction::streamProcess(int channel) {
 	delete tmpMessages;
 }
 
-void GroupbyAuction::updateExpectedValues(Message*const currentMessage, list<Message*>* & messageList, int & expected_msgid, int & expected_wid, bool & is_expected_msgid_being_processed){
+void GroupbyAuction::updateExpectedValues(Message*const currentMessage, Buffer & messages, int & expected_msgid, int & expected_wid, bool & is_expected_msgid_being_processed){
 	// we expect the next msgid to be different from the current one
 	// only if we already processed all the wids of this msgid that
 	// can be processed on this rank and on this thread.
-	int msgid_max_wid = Serialization::read_back<int>(currentMessage, sizeof(int)*2);
+	int msgid_max_wid = MessageHeader::peek(currentMessage).max_wid;
 
 	// if we have to keep the current msgid, we know the next wid is :
 	int next_wid = expected_wid + worldSize;
@@ -168,7 +164,7 @@ void GroupbyAuction::updateExpectedValues(Message*const currentMessage, list<Mes
 		// new one now :
 		is_expected_msgid_being_processed = false;
 
-		if (messageList->size() > 0) {
+		if (!messages.empty()) {
 			// we have other messages to process in the waiting list
 			// so if the next one has the expected msgid, we can
 			// determine the next expected value for wid
@@ -178,7 +174,7 @@ void GroupbyAuction::updateExpectedValues(Message*const currentMessage, list<Mes
 			// is the case, which is equivalent to calling the method
 			// initExpectedWID() (initial front message has been popped)
 
-			initExpectedWID(messageList->front(), expected_msgid, expected_wid, is_expected_msgid_being_processed);
+			initExpectedWID(messages.front(), expected_msgid, expected_wid, is_expected_msgid_being_processed);
 
 			// if the front message doesn't have the correct msgid value, 
 			// then the tread will go outside the while loop and wait for 
@@ -206,33 +202,21 @@ void GroupbyAuction::updateExpectedValues(Message*const currentMessage, list<Mes
 }
 
 
-void GroupbyAuction::sortMessages(list<Message*>* tmpMessages){
-
-	// if (rank == 1) cout <<endl << "waiting for new messages ..." << endl;
+void GroupbyAuction::bufferMessages(list<Message*>* tmpMessages, Buffer & messages){
 
-	// does what is says :
-	// primary sort criterion is msgid
-	// secondary sort criterion is wid
+	// the messages are released in order of :
+	// primary criterion msgid
+	// secondary criterion wid
 	// which ouputs something like (0; 0), (0; 3), (1; 2), ...
 	// with (msgid, wid) the template of the above tuples 
-	tmpMessages->sort(
-		[](Message*const & a, Message*const & b){
-		int a_msgid = Serialization::read_back<int>(a);
-		int b_msgid = Serialization::read_back<int>(b);
-		int a_wid = Serialization::read_back<int>(a, sizeof(int));
-		int b_wid = Serialization::read_back<int>(b, sizeof(int));
-		
-		return (a_msgid < b_msgid) || (a_msgid == b_msgid && a_wid < b_wid);
-	});
-
-	// display
-	// for (auto const & message : *tmpMessages){
-	// 	int msgid = Serialization::read_back<int>(message);
-	// 	int wid = Serialization::read_back<int>(message, sizeof(int));
-	// 	int max_wid = Serialization::read_back<int>(message, sizeof(int) * 2);
-	// 	int min_wid = Serialization::read_back<int>(message, sizeof(int) * 3);
-	// 	// if (rank == 1) cout << "msgid : " << msgid << " wid : " << wid << " min_wid : " << min_wid << " max_wid : " << max_wid << endl;
-	// }
+	// only the headers are read, the bids are not touched
+	while (!tmpMessages->empty()){
+		Message* message = tmpMessages->front();
+		tmpMessages->pop_front();
+
+		const MessageHeader& header = MessageHeader::peek(message);
+		messages.push(pair<int, int>(header.message_id, header.window_id), message);
+	}
 }
 
 void GroupbyAuction::initExpectedMID(Message*const inMessage, int & expected_msgid, bool & is_first_time){
@@ -241,7 +225,7 @@ void GroupbyAuction::initExpectedMID(Message*const inMessage, int & expected_msg
 	// some wids are in common, so be careful to use a mutex when you aggregate
 	// for a given wid.
 	if (is_first_time) {
-		int msgid = Serialization::read_back<int>(inMessage);
+		int msgid = MessageHeader::peek(inMessage).message_id;
 		expected_msgid = msgid;
 		is_first_time = false;
 
@@ -252,15 +236,16 @@ void GroupbyAuction::initExpectedMID(Message*const inMessage, int & expected_msg
 
 
 void GroupbyAuction::initExpectedWID(Message*const inMessage, const int expected_msgid, int & expected_wid, bool & is_expected_msgid_being_processed){
-	int msgid = Serialization::read_back<int>(inMessage);
+	const MessageHeader& header = MessageHeader::peek(inMessage);
+	int msgid = header.message_id;
 	
 	// if the expected msgid corresponds to the given msgid, but its processing
 	// is already under way, then the expected wid mustn't change. We have to wait
 	// for a message id with the corresponding wid.
 	if (msgid == expected_msgid && !is_expected_msgid_being_processed) {
 		is_expected_msgid_being_processed = true; // we started processing this msgid
-		int min_wid = Serialization::read_back<int>(inMessage, sizeof(int)*3); // header = msgid + wid + max_wid + min_wid
-		int max_wid = Serialization::read_back<int>(inMessage, sizeof(int)*2); // header = msgid + wid + max_wid + min_wid
+		int min_wid = header.min_wid;
+		int max_wid = header.max_wid;
 		
 		int starting_rank = (min_wid % worldSize); // rank expected to receive & process min_wid
 		if (rank >= starting_rank) {
@@ -280,8 +265,9 @@ void GroupbyAuction::initExpectedWID(Message*const inMessage, const int expected
 }
 
 bool GroupbyAuction::isMessageExpected(Message*const inMessage, const int expected_msgid, const int expected_wid){
-	int msgid = Serialization::read_back<int>(inMessage);
-	int wid = Serialization::read_back<int>(inMessage, sizeof(int));
+	const MessageHeader& header = MessageHeader::peek(inMessage);
+	int msgid = header.message_id;
+	int wid = header.window_id;
 
 	// if (msgid == expected_msgid && wid == expected_wid) {
 	// 	// if (rank == 1) cout << "message with msgid " << msgid << " and wid " << wid << " IS expected" << endl;
@@ -34,6 +34,7 @@
 #pragma once
 #include "../dataflow/Vertex.hpp"
 #include "../nexmark_hot_items/GroupbyAuction.hpp"
+#include "../dataflow/ReorderBuffer.hpp"
 
 #include <map>
 
@@ -42,9 +43,11 @@ using OriginalGroupbyAuction = nexmark_hot_items::GroupbyAuction;
 
 class GroupbyAuction: public OriginalGroupbyAuction {
 
+typedef ReorderBuffer<Message*, pair<int, int>> Buffer; // messages ordered by (msgid, wid)
+
 private:
 
-	void sortMessages(list<Message*>* tmpMessages);
+	void bufferMessages(list<Message*>* tmpMessages, Buffer & messages);
 
 	void initExpectedMID(Message*const inMessage, int & expected_msgid, bool & is_first_time);
 
@@ -52,7 +55,7 @@ private:
 
 	bool isMessageExpected(Message*const inMessage, const int expected_msgid, const int expected_wid);
 
-	void updateExpectedValues(Message*const currentMessage, list<Message*>* & messageList, int & expected_msgid, int & expected_wid, bool & is_expected_msgid_being_processed);
+	void updateExpectedValues(Message*const currentMessage, Buffer & messages, int & expected_msgid, int & expected_wid, bool & is_expected_msgid_being_processed);
 
 public:
 
@@ -33,6 +33,7 @@
 
 #include "EventCollector.hpp"
 #include "../serialization/Serialization.hpp"
+#include "../output/ResultSink.hpp"
 
 #include <string.h>
 #include <mpi.h> // includes pthreads ?
@@ -101,7 +102,9 @@ void EventCollector::processInputMessage(Message*const inMessage) {
 
     // no need for mutex because there is only one thread between the join and the collector
     avg_latency = ( avg_latency * window_id + latency ) / (window_id + 1); // window_id starts from 0 then to n-1 the number of windows processed
-    cout << "NQ8 (" << baseline << "), " << worldSize << ", " << window_id << ", " << latency << ", " << avg_latency << '\n';
+    stringstream line;
+    line << "NQ8 (" << baseline << "), " << worldSize << ", " << window_id << ", " << latency << ", " << avg_latency << '\n';
+    ResultSink::console().print(line.str());
 
     for (size_t i = 0; i < aggregates.size(); i++)
     {
@@ -44,7 +44,8 @@ using nexmark_new_sellers::JoinOutput;
 
 TumblingWindowJoin::TumblingWindowJoin(int tag, int rank, int worldSize, int window_duration) :
 Vertex(tag, rank, worldSize),
-window_duration(window_duration){
+window_duration(window_duration),
+expiry_timers((long int) (MPI_Wtime() * 1000)){
     pthread_mutex_init(&mtx, NULL);
     pthread_mutex_init(&auctions_mtx, NULL);
     pthread_mutex_init(&persons_mtx, NULL);
@@ -128,8 +129,16 @@ void TumblingWindowJoin::processInputMessage(Message*const inMessage) {
 
     // update window completeness & end time
     pthread_mutex_lock(&mtx);
-    windows[window_id].completeness++;
-    windows[window_id].timestamp_end = std::max(windows[window_id].timestamp_end, timestamp);
+    expireWindows();
+
+    if (window_id <= last_expired_window){
+        expireWindow(window_id); // too late, the window has been dropped
+    } else {
+        WindowInformation& window = windows[window_id];
+        if (window.completeness == 0) scheduleExpiry(window_id); // first message of the window
+        window.completeness++;
+        window.timestamp_end = std::max(window.timestamp_end, timestamp);
+    }
 
     // when first window is full (keeps the order), compute resulting aggregation
     if (isCurrentWindowComplete()) {
@@ -156,6 +165,8 @@ void TumblingWindowJoin::computeAggregates(){
 
 bool TumblingWindowJoin::isCurrentWindowComplete(){
 
+    if (windows.empty()) return false; // every window has expired
+
     try
     {
         WindowInformation& current_window = windows.begin()->second;
@@ -171,6 +182,42 @@ bool TumblingWindowJoin::isCurrentWindowComplete(){
     }    
 }
 
+/**
+ * A window that never completes (e.g. a lost message) would block the
+ * windows after it and stay in memory forever : each window gets a timer
+ * when its first message arrives, and is dropped if it is still there
+ * when the timer expires.
+ * */
+void TumblingWindowJoin::scheduleExpiry(const int window_id){
+    const long int now = (long int) (MPI_Wtime() * 1000);
+    expiry_timers.schedule(now + WINDOW_LIFETIME * window_duration * 1000L, window_id);
+}
+
+/**
+ * Drops the windows whose timer has expired, and the windows before them
+ * since the windows are sent in order. Must be called with mtx locked.
+ * */
+void TumblingWindowJoin::expireWindows(){
+    const long int now = (long int) (MPI_Wtime() * 1000);
+
+    for (const int window_id : expiry_timers.advance(now)){
+        auto it = windows.find(window_id);
+        if (it == windows.end()) continue; // already sent
+
+        std::cerr << "[Tumbling window join](expire windows) Window " << window_id << " expired with "
+            << it->second.completeness << " messages." << std::endl;
+        last_expired_window = std::max(last_expired_window, window_id);
+    }
+
+    while (!windows.empty() && windows.begin()->first <= last_expired_window){
+        expireWindow(windows.begin()->first);
+    }
+}
+
+void TumblingWindowJoin::expireWindow(const int window_id){
+    windows.erase(window_id);
+}
+
 void TumblingWindowJoin::processAuctionMessage(Message*const inMessage, const int window_id){
     // message header has been removed, so here we process the message content
     // when the message contains auction events, we simply process each auction
@@ -34,6 +34,7 @@
 #pragma once
 #include "../dataflow/Vertex.hpp"
 #include "PODTypesExtension.hpp"
+#include "../dataflow/TimingWheel.hpp"
 
 #include <map>
 #include <mpi.h> // for threads
@@ -42,6 +43,8 @@ namespace nexmark_new_sellers {
 using nexmark_new_sellers::JoinInputType;
 using nexmark_new_sellers::JoinOutput;
 
+static const int WINDOW_LIFETIME = 3; // in window durations, windows still incomplete after that are dropped
+
 /**
  * Vertex input : JoinInput (PersonSelection, AuctionSelection)
  * Vertex output : JoinOutput (person id and name, as well as corresponding auction reserve price)
@@ -69,6 +72,9 @@ class TumblingWindowJoin : public Vertex {
     virtual JoinOutput combine(AuctionSelection& auction, PersonSelection& person);
     virtual void send(Message*const message);
     virtual void send(Message*const message, const int channel);
+    virtual void scheduleExpiry(const int window_id);
+    virtual void expireWindows();
+    virtual void expireWindow(const int window_id);
     typedef struct {
         vector<JoinOutput> aggregates;
         vector<AuctionSelection> auctions;
@@ -79,6 +85,8 @@ class TumblingWindowJoin : public Vertex {
 
     int window_duration;
     map<int, WindowInformation> windows;
+    TimingWheel<int> expiry_timers; // ticks are milliseconds of processing time
+    int last_expired_window = -1;
 
     private:
     pthread_mutex_t mtx;
@@ -80,7 +80,7 @@ bool TumblingWindowJoin::isCurrentWindowComplete() {
     const int nof_messages_per_window = window_duration * worldSize * PER_SEC_MSG_COUNT * 2;
 
     // map is from smallest to highest, if that's not the case we should use completeness.end()
-    if (completeness.begin()->second == nof_messages_per_window){
+    if (!completeness.empty() && completeness.begin()->second == nof_messages_per_window){
         return true;
     } else {
         pthread_mutex_unlock(&fw_mut);
@@ -88,6 +88,11 @@ bool TumblingWindowJoin::isCurrentWindowComplete() {
     }
 }
 
+void TumblingWindowJoin::expireWindow(const int window_id){
+    completeness.erase(window_id);
+    OriginalTumblingWindowJoin::expireWindow(window_id);
+}
+
 Message*const TumblingWindowJoin::initMessage(size_t capacity){
     return OriginalTumblingWindowJoin::initMessage(capacity + sizeof(WrapperUnit));
 }
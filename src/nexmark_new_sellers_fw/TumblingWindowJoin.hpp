@@ -55,6 +55,7 @@ class TumblingWindowJoin : public OriginalTumblingWindowJoin {
     virtual bool isCurrentWindowComplete();
     virtual Message*const initMessage(size_t message_size);
     virtual void send(Message*const message, const int channel);
+    virtual void expireWindow(const int window_id);
 
     private:
     pthread_mutex_t fw_mut;
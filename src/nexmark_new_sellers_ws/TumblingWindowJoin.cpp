@@ -52,16 +52,17 @@ void TumblingWindowJoin::streamProcess(int channel) {
 		int expected_msgid = channel % worldSize;
         
         list<Message*>* tmpMessages = new list<Message*>();
+        Buffer messages;
 
         while (ALIVE) {
 
             updateInputMessages(tmpMessages, channel);
-            sortMessages(tmpMessages); // new
+            bufferMessages(tmpMessages, messages); // new
 
 			// new condition
-            while (!tmpMessages->empty() && isMessageExpected(tmpMessages->front(), expected_msgid)) {
+            while (!messages.empty() && isMessageExpected(messages.front(), expected_msgid)) {
 
-                Message* inMessage = tmpMessages->front();
+                Message* inMessage = messages.pop();
                 
                 try
                 {
@@ -72,7 +73,6 @@ void TumblingWindowJoin::streamProcess(int channel) {
                     std::cerr << e << '\n';
                 }
                 
-                tmpMessages->pop_front();
                 delete inMessage;
 
                 updateExpectedValues(expected_msgid); // new
@@ -83,16 +83,15 @@ void TumblingWindowJoin::streamProcess(int channel) {
     }
 }
 
-void TumblingWindowJoin::sortMessages(list<Message*>* tmpMessages){
+void TumblingWindowJoin::bufferMessages(list<Message*>* tmpMessages, Buffer & messages){
+
+	while (!tmpMessages->empty()) {
+		Message* message = tmpMessages->front();
+		tmpMessages->pop_front();
 
-	tmpMessages->sort(
-		[](Message*const & a, Message*const & b){
-		int a_msgid = Serialization::read_back<int>(a);
-		int b_msgid = Serialization::read_back<int>(b);
-		
         // smallest msgid first
-		return (a_msgid < b_msgid);
-	});
+		messages.push(Serialization::read_back<int>(message), message);
+	}
 }
 
 bool TumblingWindowJoin::isMessageExpected(Message*const inMessage, const int expected_msgid){
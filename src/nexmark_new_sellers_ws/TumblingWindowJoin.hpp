@@ -33,19 +33,22 @@
 
 #pragma once
 #include "../nexmark_new_sellers/TumblingWindowJoin.hpp"
+#include "../dataflow/ReorderBuffer.hpp"
 
 namespace nexmark_new_sellers_ws {
 using OriginalTumblingWindowJoin = nexmark_new_sellers::TumblingWindowJoin;
 
 class TumblingWindowJoin : public OriginalTumblingWindowJoin {
 
+    typedef ReorderBuffer<Message*, int> Buffer; // messages ordered by msgid
+
     public:
     TumblingWindowJoin(int tag, int rank, int worldSize, int window_duration);
     void streamProcess(int channel) override;
 
     protected:
-    // message sorting by msgid
-    virtual void sortMessages(list<Message*>* tmpMessages);
+    // message ordering by msgid
+    virtual void bufferMessages(list<Message*>* tmpMessages, Buffer & messages);
     virtual bool isMessageExpected(Message*const inMessage, const int expected_msgid);
     virtual void updateExpectedValues(int & expected_msgid);
 
@@ -0,0 +1,156 @@
+/**
+ * Copyright (c) 2020 University of Luxembourg. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF LUXEMBOURG AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE UNIVERSITY OF LUXEMBOURG OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+/*
+ * ResultSink.cpp
+ */
+
+#include "ResultSink.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+ResultSink::ResultSink(const string& fileName, SinkEncoding encoding) :
+		encoding(encoding), pending(nullptr), closing(false), closed(false) {
+
+	this->fd = ::open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	this->owns_fd = true;
+
+	// like the data files of the operators, results are dropped when the
+	// file can't be created (e.g. no Data directory)
+	if (fd < 0)
+		cerr << "[ResultSink] Cannot open " << fileName << " : "
+				<< strerror(errno) << ", results are dropped" << endl;
+
+	start();
+}
+
+ResultSink::ResultSink(int fd, SinkEncoding encoding) :
+		fd(fd), owns_fd(false), encoding(encoding), pending(nullptr), closing(
+				false), closed(false) {
+	start();
+}
+
+ResultSink::~ResultSink() {
+	close();
+}
+
+void ResultSink::start() {
+	pthread_create(&writer, NULL, &ResultSink::run, this);
+}
+
+void ResultSink::print(const string& text) {
+	submit(string(text));
+}
+
+/**
+ * Lock-free push of a chunk on the pending list (several processing
+ * threads may submit at the same time, only the writer thread takes).
+ */
+void ResultSink::submit(string&& data) {
+	Chunk* chunk = new Chunk { move(data), pending.load(memory_order_relaxed) };
+	while (!pending.compare_exchange_weak(chunk->next, chunk,
+			memory_order_release, memory_order_relaxed))
+		;
+}
+
+/**
+ * Takes all the pending chunks and writes them in submission order.
+ */
+void ResultSink::drain() {
+
+	Chunk* chunk = pending.exchange(nullptr, memory_order_acquire);
+	if (chunk == nullptr)
+		return;
+
+	// the list holds the latest chunk first
+	Chunk* ordered = nullptr;
+	size_t length = 0;
+	while (chunk != nullptr) {
+		Chunk* next = chunk->next;
+		chunk->next = ordered;
+		ordered = chunk;
+		length += chunk->data.size();
+		chunk = next;
+	}
+
+	string buffer;
+	buffer.reserve(length);
+	while (ordered != nullptr) {
+		Chunk* next = ordered->next;
+		buffer += ordered->data;
+		delete ordered;
+		ordered = next;
+	}
+
+	size_t written = 0;
+	while (fd >= 0 && written < buffer.size()) {
+		ssize_t res = ::write(fd, buffer.data() + written,
+				buffer.size() - written);
+		if (res < 0) {
+			if (errno == EINTR)
+				continue;
+			cerr << "[ResultSink] Write failed : " << strerror(errno) << endl;
+			break;
+		}
+		written += res;
+	}
+}
+
+void* ResultSink::run(void* sink) {
+
+	ResultSink* self = (ResultSink*) sink;
+
+	while (!self->closing.load()) {
+		usleep(SINK_FLUSH_INTERVAL * 1000);
+		self->drain();
+	}
+
+	self->drain(); // chunks submitted before close
+	return NULL;
+}
+
+void ResultSink::close() {
+	if (closed)
+		return;
+	closed = true;
+
+	closing.store(true);
+	pthread_join(writer, NULL);
+
+	if (owns_fd && fd >= 0)
+		::close(fd);
+}
+
+ResultSink& ResultSink::console() {
+	static ResultSink console(STDOUT_FILENO, ENCODING_CSV);
+	return console;
+}
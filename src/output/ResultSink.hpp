@@ -0,0 +1,157 @@
+/**
+ * Copyright (c) 2020 University of Luxembourg. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF LUXEMBOURG AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE UNIVERSITY OF LUXEMBOURG OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+/*
+ * ResultSink.hpp
+ */
+
+#ifndef OUTPUT_RESULTSINK_HPP_
+#define OUTPUT_RESULTSINK_HPP_
+
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+#include "../serialization/Codec.hpp"
+
+using namespace std;
+
+enum SinkEncoding {
+	ENCODING_BINARY, // records as they are stored in messages (see Codec)
+	ENCODING_CSV // one line per record, with a header line
+};
+
+static const long SINK_FLUSH_INTERVAL = 50; // MSEC between two writes of the writer thread
+
+/**
+ * Output of the results of an operator, written by a dedicated writer thread.
+ *
+ * The processing threads only encode their records into a chunk and push it
+ * on a lock-free list, they never wait for the file (or the terminal). The
+ * writer thread takes the whole list every SINK_FLUSH_INTERVAL and writes the
+ * chunks, in the order they were submitted, with a single write(2) call.
+ *
+ * ResultSink::console() is the sink of the standard output, for the lines
+ * that are printed for every window. Sinks of records of type R are opened
+ * with ResultSink::open<R>, which writes the CSV header of R first.
+ */
+class ResultSink {
+
+public:
+
+	ResultSink(int fd, SinkEncoding encoding);
+
+	~ResultSink();
+
+	// sink of the records of type R, starting with their header in CSV
+	template<typename R>
+	static ResultSink* open(const string& fileName, SinkEncoding encoding = ENCODING_CSV);
+
+	template<typename R>
+	void write(const R* records, size_t nof_records);
+
+	template<typename R>
+	void write(const vector<R>& records);
+
+	// hands over preformatted text
+	void print(const string& text);
+
+	// writes the pending chunks and stops the writer thread
+	void close();
+
+	static ResultSink& console();
+
+private:
+
+	// record sinks are opened with open<R>, for their header
+	ResultSink(const string& fileName, SinkEncoding encoding);
+
+	struct Chunk {
+		string data;
+		Chunk* next;
+	};
+
+	int fd;
+	bool owns_fd;
+	SinkEncoding encoding;
+
+	atomic<Chunk*> pending; // latest chunk first
+	atomic<bool> closing;
+	bool closed;
+
+	pthread_t writer;
+
+	void start();
+
+	void submit(string&& data);
+
+	void drain();
+
+	static void* run(void* sink);
+};
+
+template<typename R>
+ResultSink* ResultSink::open(const string& fileName, SinkEncoding encoding) {
+	ResultSink* sink = new ResultSink(fileName, encoding);
+
+	// submitted before the sink is shared with the processing threads
+	if (encoding == ENCODING_CSV) {
+		stringstream ss;
+		Codec<R>::csvHeader(ss);
+		sink->submit(ss.str());
+	}
+
+	return sink;
+}
+
+template<typename R>
+void ResultSink::write(const R* records, size_t nof_records) {
+	static_assert(std::is_trivially_copyable<R>::value, "records are written as they are in memory");
+
+	if (nof_records == 0)
+		return;
+
+	if (encoding == ENCODING_BINARY) {
+		string data(nof_records * Codec<R>::stride, '\0');
+		memcpy(&data[0], records, nof_records * Codec<R>::stride);
+		submit(move(data));
+		return;
+	}
+
+	stringstream ss;
+	for (size_t i = 0; i < nof_records; i++)
+		Codec<R>::csv(records[i], ss);
+	submit(ss.str());
+}
+
+template<typename R>
+void ResultSink::write(const vector<R>& records) {
+	write(records.data(), records.size());
+}
+
+#endif /* OUTPUT_RESULTSINK_HPP_ */
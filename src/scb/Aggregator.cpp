@@ -7,7 +7,7 @@ using namespace scb;
  * Simple constructor to initialize the values of the count aggregator.
  * */
 Aggregator::Aggregator(const int tag, const int rank, const int worldSize) :
-CountAggregator<Event>(tag, rank, worldSize){
+CountAggregator<Event, Count>(tag, rank, worldSize){
     setBaseline('c');
 }
 
@@ -17,7 +17,7 @@ CountAggregator<Event>(tag, rank, worldSize){
 void Aggregator::streamProcess(int channel){
     if (rank == SCB::aggregator_rank){
 
-        CountAggregator<Event>::streamProcess(channel);
+        CountAggregator<Event, Count>::streamProcess(channel);
     }
 }
 
@@ -7,8 +7,9 @@ namespace scb { // add class to benchmark namespace
 
 using WindowID = int;
 using Event = pair<WindowID, int>;
+using Count = CountAccumulator<Event>; // windows only keep their number of events
 
-class Aggregator: public CountAggregator<Event> {
+class Aggregator: public CountAggregator<Event, Count> {
 
 public:
 
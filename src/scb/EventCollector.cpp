@@ -1,5 +1,6 @@
 #include "EventCollector.hpp"
 #include "../usecases/SCB.hpp"
+#include "../output/ResultSink.hpp"
 
 #include <mpi.h>
 
@@ -24,13 +25,11 @@ void EventCollector::streamProcess(int channel) {
 	if (rank == SCB::aggregator_rank) {
 
 		if (channel == 0){
-			cout << "window_id, count\n";
+			ResultSink::console().print("window_id, count\n");
 		}
 
-		list<message_ptr> pthread_waiting_list;
-
 		while (ALIVE) {
-			message_ptr message = fetchNextMessage(channel, pthread_waiting_list);
+			message_ptr message = fetchNextMessage(channel);
 			processMessage(move(message)); // no need to send a result
 			// no message sent
 		}
@@ -39,8 +38,9 @@ void EventCollector::streamProcess(int channel) {
 }
 
 vector<output_data> EventCollector::processMessage(message_ptr message){
-	int window_id = readMessageID(message);
-    char input_baseline = readBaseline(message);
+	const MessageHeader header = readHeader(message);
+	int window_id = header.window_id;
+    char input_baseline = header.baseline;
 
     if(input_baseline != getBaseline()){
         throw "[EventCollector](processMessage) Unrecognized aggregation protocol.";
@@ -55,5 +55,11 @@ vector<output_data> EventCollector::processMessage(message_ptr message){
 	size_t count = events.front(); // message should contain one event whose value is the count of events.
 
 	// debug
-	cout << window_id << ", " << count << endl;
+	stringstream line;
+	line << window_id << ", " << count;
+	if (header.flags & WINDOW_DELTA){
+		line << ", late"; // late events of the window, to add to its previous counts
+	}
+	line << '\n';
+	ResultSink::console().print(line.str());
 }
@@ -72,9 +72,8 @@ vector<output_data> EventGenerator::generateMessages(const unsigned int quantity
 			Serialization::wrap<Event>(generateEvent(window_id), message.get());
 		}
 
-		// add message id and baseline
-		Serialization::wrap<char>(getBaseline(), message.get());
-		Serialization::wrap<int>(message_id, message.get());
+		// add message id, window id and baseline
+		writeHeader(message.get(), message_id, window_id);
 
 		// add message to output
 		destination dest = vector<int>({aggregator_rank});
@@ -7,7 +7,7 @@ using namespace scb_fw;
  * Simple constructor to initialize the values of the count aggregator.
  * */
 Aggregator::Aggregator(const int tag, const int rank, const int worldSize) :
-FlowWrappingAggregator<Event>(tag, rank, worldSize){
+FlowWrappingAggregator<Event, Count>(tag, rank, worldSize){
     setBaseline('w');
 }
 
@@ -17,7 +17,7 @@ FlowWrappingAggregator<Event>(tag, rank, worldSize){
 void Aggregator::streamProcess(int channel){
 
     if (rank == SCBFW::aggregator_rank){
-        FlowWrappingAggregator<Event>::streamProcess(channel);
+        FlowWrappingAggregator<Event, Count>::streamProcess(channel);
     }
 }
 
@@ -7,8 +7,9 @@ namespace scb_fw {
 
 using WindowID = int;
 using Event = pair<WindowID, int>;
+using Count = CountAccumulator<Event>; // windows only keep their number of events
 
-class Aggregator: public FlowWrappingAggregator<Event> {
+class Aggregator: public FlowWrappingAggregator<Event, Count> {
 
 public:
 
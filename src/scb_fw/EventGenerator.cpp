@@ -13,7 +13,7 @@ scb::EventGenerator(tag, rank, worldSize)
 	this->aggregator_rank = scb_fw::SCBFW::aggregator_rank;
 
 	setBaseline('w'); // flow-wrapping baseline
-    increaseHeaderSize(sizeof(WrapperUnit));
+    increaseHeaderSize(MessageHeader::length(1) - MessageHeader::length(0)); // padding may already leave room for it
 }
 
 /**
@@ -27,8 +27,13 @@ vector<output_data> EventGenerator::generateMessages(const unsigned int quantity
     wu.completeness_tag_numerator = 1;
     wu.completeness_tag_denominator = SCBFW::window_duration * PER_SEC_MSG_COUNT * worldSize; // should be the same in the aggregator
 
+    // the space of a wrapper unit was reserved in the header (cf. constructor)
     for(size_t i = 0; i < out.size(); i++){
-        Serialization::wrap<WrapperUnit>(wu, out[i].first.get());
+        Message* message = out[i].first.get();
+        MessageHeader header = MessageHeader::read(message);
+        header.nof_wrapper_units = 1;
+        MessageHeader::write(header, message);
+        MessageHeader::writeWrapperUnit(wu, 0, message);
     }
 
 	return out;
@@ -53,8 +58,8 @@ vector<output_data> EventGenerator::delay(vector<output_data> input){
 	for(size_t i = 0; i < PER_SEC_MSG_COUNT; i++){
 		if (!splitter[i].empty()) {
 			output_data concat = concatenate(move(splitter[i])); // also add the number of wrapper units even if there is only one
-			// cout << "nof wu: " << Serialization::read_back<int>(concat.first.get()) << endl;
-			// cout << "window: " << Serialization::read_back<WrapperUnit>(concat.first.get(), sizeof(int)).window_start_time << endl;
+			// cout << "nof wu: " << MessageHeader::peek(concat.first.get()).nof_wrapper_units << endl;
+			// cout << "window: " << MessageHeader::readWrapperUnit(concat.first.get(), 0).window_start_time << endl;
 			out.push_back(move(concat));
 		}
 	}
@@ -82,26 +87,24 @@ output_data EventGenerator::concatenate(vector<output_data> input){
 	}
 
 	// create new output data
-	message_ptr out = createMessage(size + sizeof(WrapperUnit) * (input.size() - 1) + sizeof(int)); // 1 wrapper unit per message concatenated and A int to indicate how many wrapper units there are
+	const size_t header_length = MessageHeader::length(input.size()); // 1 wrapper unit per message concatenated
+	message_ptr out(new Message(header_length + size));
 	destination dest = vector<int>({0}); // copy vector, cf. note above method
 
+	// the header (baseline + msgid) is the one of the first message, followed by all the wrapper units
+	MessageHeader header = readHeader(input[0].first);
+	header.nof_wrapper_units = input.size();
+	MessageHeader::write(header, out.get());
+	out->size = header_length;
+
 	// fill content (copy only the content of each message and not the header)
-	vector<WrapperUnit> units;
 	for (size_t i = 0; i < input.size(); i++){
-		Serialization::append(out.get(), input[i].first.get(), getHeaderSize());
-		WrapperUnit wu = Serialization::unwrap<WrapperUnit>(input[i].first.get());
-		units.push_back(wu);
-	}
+		const Message* message = input[i].first.get();
+		MessageHeader::writeWrapperUnit(MessageHeader::readWrapperUnit(message, 0), i, out.get());
 
-	// and finally, add the header (baseline + msgid + wrapper units + nof wrapper units)
-	int message_id = readMessageID(input[0].first); 
-	char baseline = readBaseline(input[0].first);
-	Serialization::wrap<char>(baseline, out.get());
-	Serialization::wrap<int>(message_id, out.get());
-	for(size_t i = 0; i < units.size(); i++){
-		Serialization::wrap<WrapperUnit>(units[i], out.get());
+		memcpy(out->buffer + out->size, message->buffer + getHeaderSize(), message->size - getHeaderSize());
+		out->size += message->size - getHeaderSize();
 	}
-	Serialization::wrap<int>(units.size(), out.get());
 
 	return make_pair(move(out), dest);
 }
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include "../usecases/SCBWM.hpp"
+#include "Aggregator.hpp"
+
+using namespace scb_wm;
+
+/**
+ * Simple constructor to initialize the values of the watermark aggregator.
+ * */
+Aggregator::Aggregator(const int tag, const int rank, const int worldSize) :
+WatermarkAggregator<Event, Count>(tag, rank, worldSize){
+    setBaseline('e');
+}
+
+/**
+ * We modify the stream processing protocol because we only want one instance of the aggregator.
+ * */
+void Aggregator::streamProcess(int channel){
+
+    if (rank == SCBWM::aggregator_rank){
+        WatermarkAggregator<Event, Count>::streamProcess(channel);
+    }
+}
+
+/**
+ * Implementation of a tumbling window with the duration defined in the usecase definition file.
+ * (usecases/SCBWM.hpp)
+ * 
+ * The generator directly sends us the window ids, cf. scb::Aggregator.
+ * */
+vector<int> Aggregator::getWindowIDs(const Event& event){
+    return vector<int>({event.first}); // left member of the pair is the window_id in that case
+}
+
+/**
+ * Window window_id holds the events generated during the iterations
+ * [window_id * window_duration, (window_id + 1) * window_duration), the
+ * watermarks of the generators are iterations as well.
+ * */
+long int Aggregator::getWindowEnd(int window_id){
+    return (long int) (window_id + 1) * SCBWM::window_duration;
+}
+
+/**
+ * Windows fire as soon as the watermark passes their end, the delayed
+ * messages update them afterwards (cf. the watermarks of the generator).
+ * */
+long int Aggregator::getAllowedLateness(){
+    return SCBWM::allowed_lateness;
+}
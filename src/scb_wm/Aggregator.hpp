@@ -0,0 +1,28 @@
+#pragma once
+#include "../dataflow/WatermarkAggregator.hpp"
+
+using namespace std;
+
+namespace scb_wm {
+
+using WindowID = int;
+using Event = pair<WindowID, int>;
+using Count = CountAccumulator<Event>; // windows only keep their number of events
+
+class Aggregator: public WatermarkAggregator<Event, Count> {
+
+public:
+
+	Aggregator(int tag, int rank, int worldSize);
+	void streamProcess(int channel);
+
+protected:
+	
+	vector<int> getWindowIDs(const Event& event);
+	long int getWindowEnd(int window_id);
+	long int getAllowedLateness();
+
+	// default window processing is counting events.
+
+};
+};
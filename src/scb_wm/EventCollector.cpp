@@ -0,0 +1,11 @@
+#include "EventCollector.hpp"
+
+using namespace scb_wm;
+
+/**
+ * Simple constructor.
+ * */
+EventCollector::EventCollector(const int tag, const int rank, const int worldSize) :
+scb::EventCollector(tag, rank, worldSize) {
+	setBaseline('e');
+}
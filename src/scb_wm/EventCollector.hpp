@@ -0,0 +1,12 @@
+#pragma once
+#include "../scb/EventCollector.hpp"
+
+namespace scb_wm {
+class EventCollector: public scb::EventCollector {
+
+public:
+
+	EventCollector(const int tag, const int rank, const int worldSize);
+
+};
+};
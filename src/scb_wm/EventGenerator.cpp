@@ -0,0 +1,67 @@
+#include "EventGenerator.hpp"
+#include "../usecases/SCBWM.hpp"
+
+#include <algorithm> // min
+
+using namespace scb_wm;
+
+EventGenerator::EventGenerator(const int tag, const int rank, const int worldSize) :
+scb::EventGenerator(tag, rank, worldSize)
+{
+	this->window_duration = scb_wm::SCBWM::window_duration;
+	this->delay_probability = scb_wm::SCBWM::delay_probability;
+	this->delay_min_duration = scb_wm::SCBWM::delay_min_duration;
+	this->delay_max_duration = scb_wm::SCBWM::delay_max_duration;
+	this->aggregator_rank = scb_wm::SCBWM::aggregator_rank;
+
+	setBaseline('e'); // event-time watermark baseline
+}
+
+/**
+ * Same generation method as scb (count) but the header carries the
+ * event time of the message.
+ * */
+vector<output_data> EventGenerator::generateMessages(const unsigned int quantity){
+	vector<output_data> out = move(scb::EventGenerator::generateMessages(quantity));
+
+	for(size_t i = 0; i < out.size(); i++){
+		Message* message = out[i].first.get();
+		MessageHeader header = MessageHeader::read(message);
+		header.timestamp = iteration;
+		MessageHeader::write(header, message);
+	}
+
+	return out;
+}
+
+/**
+ * The watermark of a message is the oldest event time that may still be
+ * sent after it : the next messages are generated at the next iteration,
+ * unless some older messages are still delayed or follow in this batch
+ * (the messages whose delay is over are sent last).
+ *
+ * The watermark doesn't wait for the delayed messages longer than the
+ * allowed lateness of the aggregator : their windows are output on time
+ * and updated when they arrive, none of them is dropped.
+ * */
+void EventGenerator::send(vector<output_data> messages){
+	const long int lateness = scb_wm::SCBWM::allowed_lateness;
+
+	long int watermark = iteration + 1;
+	for (const vector<output_data>& delayed : messages_with_delays){
+		for (const output_data& data : delayed){
+			watermark = std::min(watermark, MessageHeader::peek(data.first.get()).timestamp + lateness);
+		}
+	}
+
+	for(size_t i = messages.size(); i-- > 0;){
+		Message* message = messages[i].first.get();
+		MessageHeader header = MessageHeader::read(message);
+		header.watermark = watermark;
+		MessageHeader::write(header, message);
+
+		watermark = std::min(watermark, header.timestamp + lateness);
+	}
+
+	scb::EventGenerator::send(move(messages));
+}
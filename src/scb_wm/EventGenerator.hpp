@@ -0,0 +1,29 @@
+#pragma once
+#include "../scb/EventGenerator.hpp"
+
+namespace scb_wm {
+
+/**
+ * Random generator of integers (100 values + baseline + msgid).
+ * This implementation is dedicated to the watermark baseline.
+ * 
+ * The event time of a message is the iteration (second) it was generated
+ * in, and every message carries the low watermark of the generator : the
+ * oldest event time it may still send, delayed messages included.
+ * */
+class EventGenerator: public scb::EventGenerator {
+
+public:
+
+	// here we only need to make sure that the correct baseline is used.
+	EventGenerator(const int tag, const int rank, const int worldSize);
+
+protected:
+
+	// add the event time
+	virtual vector<output_data> generateMessages(const unsigned int quantity);
+	// add the watermark
+	virtual void send(vector<output_data> messages);
+
+};
+};
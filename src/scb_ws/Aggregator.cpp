@@ -7,7 +7,7 @@ using namespace scb_ws;
  * Simple constructor to initialize the values of the count aggregator.
  * */
 Aggregator::Aggregator(const int tag, const int rank, const int worldSize) :
-SortAggregator<Event>(tag, rank, worldSize){
+SortAggregator<Event, Count>(tag, rank, worldSize){
     setBaseline('s');
 }
 
@@ -16,7 +16,7 @@ SortAggregator<Event>(tag, rank, worldSize){
  * */
 void Aggregator::streamProcess(int channel){
     if (rank == SCBWS::aggregator_rank){
-        SortAggregator<Event>::streamProcess(channel);
+        SortAggregator<Event, Count>::streamProcess(channel);
     }
 }
 
@@ -5,8 +5,9 @@ namespace scb_ws { // add class to benchmark namespace
 
 using WindowID = int;
 using Event = pair<WindowID, int>;
+using Count = CountAccumulator<Event>; // windows only keep their number of events
 
-class Aggregator: public SortAggregator<Event> {
+class Aggregator: public SortAggregator<Event, Count> {
 
 public:
 
@@ -0,0 +1,250 @@
+/**
+ * Copyright (c) 2020 University of Luxembourg. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF LUXEMBOURG AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE UNIVERSITY OF LUXEMBOURG OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+/*
+ * Codec.hpp
+ */
+
+#ifndef SERIALIZATION_CODEC_HPP_
+#define SERIALIZATION_CODEC_HPP_
+
+#include "../communication/Message.hpp"
+
+#include <cstddef> // offsetof
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <tuple>
+#include <type_traits>
+#include <utility> // index_sequence
+#include <vector>
+
+/**
+ * Compile-time description of the records exchanged between operators.
+ * 
+ * A record type declares its fields once, with the RECORD_SCHEMA macro (after the
+ * struct definition, at global scope) :
+ * 
+ *     RECORD_SCHEMA(EventPA,
+ *         RECORD_FIELD(EventPA, max_event_time),
+ *         RECORD_FIELD(EventPA, c_id),
+ *         RECORD_FIELD(EventPA, count))
+ * 
+ * Codec<T> then provides the serialization methods of the record. A record
+ * takes sizeof(T) bytes in a message and its fields are stored at their
+ * offset in the struct, so serializing one record, or an array of records,
+ * is a single memcpy when the type is trivially copyable.
+ * 
+ * The layout is checked at compile time (fields inside the struct, in
+ * declaration order, without overlapping).
+ * */
+
+template<typename T, typename M>
+struct Field {
+	const char* name;
+	M T::* member;
+	size_t offset;
+	size_t size;
+};
+
+template<typename T, typename M>
+constexpr Field<T, M> makeField(const char* name, M T::* member, const size_t offset) {
+	return Field<T, M>{name, member, offset, sizeof(M)};
+}
+
+// fields() returns a tuple of Field, one per serialized member
+template<typename T>
+struct RecordSchema;
+
+#define RECORD_FIELD(Type, member) makeField(#member, &Type::member, offsetof(Type, member))
+
+#define RECORD_SCHEMA(Type, ...) \
+	template<> \
+	struct RecordSchema<Type> { \
+		static constexpr auto fields() { return std::make_tuple(__VA_ARGS__); } \
+	}; \
+	static_assert(RecordLayout<Type>::isValid(), "Invalid record layout for " #Type);
+
+/**
+ * Compile-time checks on the fields declared in a schema.
+ * */
+template<typename T>
+struct RecordLayout {
+
+	static constexpr size_t nof_fields = std::tuple_size<decltype(RecordSchema<T>::fields())>::value;
+
+	static constexpr bool isValid() {
+		return std::is_standard_layout<T>::value
+			&& nof_fields > 0
+			&& isOrdered(std::make_index_sequence<nof_fields>());
+	}
+
+private:
+
+	template<size_t... I>
+	static constexpr bool isOrdered(std::index_sequence<I...>) {
+		size_t end = 0;
+		for (const auto& field : {std::make_pair(std::get<I>(RecordSchema<T>::fields()).offset, std::get<I>(RecordSchema<T>::fields()).size)...}) {
+			if (field.first < end) return false; // overlapping or unordered fields
+			end = field.first + field.second;
+		}
+		return end <= sizeof(T);
+	}
+};
+
+/**
+ * Serialization of the records described by a RecordSchema. Messages are filled
+ * from message->size (like Serialization::wrap) and read at a given offset.
+ * */
+template<typename T>
+class Codec {
+
+public:
+
+	static const size_t stride = sizeof(T); // bytes taken by one record in a message
+
+	static void serialize(const T& event, Message*const message) {
+		encode(&event, 1, message);
+	}
+
+	static void deserialize(const Message*const message, T& event, const size_t offset) {
+		decode(message, offset, &event, 1);
+	}
+
+	// appends nof_events records to the message
+	static void encode(const T*const events, const size_t nof_events, Message*const message) {
+		const size_t length = nof_events * stride;
+		if (message->size + length > (size_t) message->capacity) {
+			std::stringstream ss;
+			ss << "[Codec](encode) Message capacity is too small : " << message->capacity
+			<< " (size " << message->size << ", append " << length << ")";
+			throw ss.str();
+		}
+
+		write(message->buffer + message->size, events, nof_events, std::is_trivially_copyable<T>());
+		message->size += length;
+	}
+
+	static void encode(const std::vector<T>& events, Message*const message) {
+		encode(events.data(), events.size(), message);
+	}
+
+	// reads nof_events records, starting at the given offset
+	static void decode(const Message*const message, const size_t offset, T*const events, const size_t nof_events) {
+		if (offset + nof_events * stride > (size_t) message->size) {
+			std::stringstream ss;
+			ss << "[Codec](decode) Message size is too small : " << message->size
+			<< " (offset " << offset << ", read " << nof_events * stride << ")";
+			throw ss.str();
+		}
+
+		read(message->buffer + offset, events, nof_events, std::is_trivially_copyable<T>());
+	}
+
+	// reads all the records found after the given offset
+	static std::vector<T> decode(const Message*const message, const size_t offset) {
+		std::vector<T> events(count(message, offset));
+		decode(message, offset, events.data(), events.size());
+		return events;
+	}
+
+	static size_t count(const Message*const message, const size_t offset) {
+		return (message->size - offset) / stride;
+	}
+
+	// prints "name: value" for every field
+	static void print(const T& event, std::ostream& out = std::cout) {
+		print(event, out, std::make_index_sequence<RecordLayout<T>::nof_fields>());
+		out << std::endl;
+	}
+
+	// writes one CSV line with the values of the fields
+	static void csv(const T& event, std::ostream& out) {
+		csv(event, out, std::make_index_sequence<RecordLayout<T>::nof_fields>());
+		out << '\n';
+	}
+
+	// writes the CSV line with the names of the fields
+	static void csvHeader(std::ostream& out) {
+		csvHeader(out, std::make_index_sequence<RecordLayout<T>::nof_fields>());
+		out << '\n';
+	}
+
+private:
+
+	static void write(char* buffer, const T*const events, const size_t nof_events, std::true_type) {
+		memcpy(buffer, events, nof_events * stride);
+	}
+
+	static void read(const char* buffer, T*const events, const size_t nof_events, std::true_type) {
+		memcpy(events, buffer, nof_events * stride);
+	}
+
+	// field by field copy for the types that can't be copied as a whole
+	static void write(char* buffer, const T*const events, const size_t nof_events, std::false_type) {
+		for (size_t i = 0; i < nof_events; i++) {
+			writeFields(buffer + i * stride, events[i], std::make_index_sequence<RecordLayout<T>::nof_fields>());
+		}
+	}
+
+	static void read(const char* buffer, T*const events, const size_t nof_events, std::false_type) {
+		for (size_t i = 0; i < nof_events; i++) {
+			readFields(buffer + i * stride, events[i], std::make_index_sequence<RecordLayout<T>::nof_fields>());
+		}
+	}
+
+	template<size_t... I>
+	static void writeFields(char* buffer, const T& event, std::index_sequence<I...>) {
+		constexpr auto fields = RecordSchema<T>::fields();
+		(void) std::initializer_list<int>{(memcpy(buffer + std::get<I>(fields).offset, &(event.*(std::get<I>(fields).member)), std::get<I>(fields).size), 0)...};
+	}
+
+	template<size_t... I>
+	static void readFields(const char* buffer, T& event, std::index_sequence<I...>) {
+		constexpr auto fields = RecordSchema<T>::fields();
+		(void) std::initializer_list<int>{(memcpy(&(event.*(std::get<I>(fields).member)), buffer + std::get<I>(fields).offset, std::get<I>(fields).size), 0)...};
+	}
+
+	template<size_t... I>
+	static void print(const T& event, std::ostream& out, std::index_sequence<I...>) {
+		constexpr auto fields = RecordSchema<T>::fields();
+		(void) std::initializer_list<int>{(out << (I == 0 ? "" : "\t") << std::get<I>(fields).name << ": " << event.*(std::get<I>(fields).member), 0)...};
+	}
+
+	template<size_t... I>
+	static void csv(const T& event, std::ostream& out, std::index_sequence<I...>) {
+		constexpr auto fields = RecordSchema<T>::fields();
+		(void) std::initializer_list<int>{(out << (I == 0 ? "" : ",") << event.*(std::get<I>(fields).member), 0)...};
+	}
+
+	template<size_t... I>
+	static void csvHeader(std::ostream& out, std::index_sequence<I...>) {
+		constexpr auto fields = RecordSchema<T>::fields();
+		(void) std::initializer_list<int>{(out << (I == 0 ? "" : ",") << std::get<I>(fields).name, 0)...};
+	}
+};
+
+#endif /* SERIALIZATION_CODEC_HPP_ */
@@ -32,6 +32,7 @@
  */
 
 #include <iostream>
+#include <sstream>
 #include <string>
 
 #include "Serialization.hpp"
@@ -98,52 +99,49 @@ void Serialization::encodeFloat(char* chars, float val) {
 }
 
 void Serialization::YSBserializeDG(EventDG* event, Message* message) {
-	char* b = message->buffer + message->size;
-	memcpy(b, &event->event_time, 8);
-	b += 8;
-	memcpy(b, &event->event_type, 9);
-	b +=9;
-	memcpy(b, event->ad_id, 37);
-	b += 37;
-	memcpy(b, event->userid_pageid_ipaddress, 82);
-	message->size += sizeof(EventDG);
+	Codec<EventDG>::serialize(*event, message);
 }
 
 void Serialization::YSBdeserializeDG(Message* message, EventDG* event,
 		int offset) {
-	char* b = message->buffer + offset;
-	memcpy(&event->event_time, b, 8);
-	b += 8;
-	memcpy(&event->event_type, b, 9);
-	b += 9;
-	memcpy(event->ad_id, b, 37);
-	b += 37;
-	memcpy(event->userid_pageid_ipaddress, b, 82);
+	Codec<EventDG>::deserialize(message, *event, offset);
 }
 
 void Serialization::YSBprintDG(EventDG* event) {
-	cout << "event_time: " << event->event_time << "\tevent_type: "
-			<< event->event_type << "\tad_id: " << event->ad_id
-			<< "\tuser_id, page_id, ip_address: "
-			<< event->userid_pageid_ipaddress << endl;
+	Codec<EventDG>::print(*event);
 }
 
 void Serialization::unwrapFirstWU(Message* message, WrapperUnit* wu) {
-	memcpy(&wu->window_start_time, message->buffer + 4, 8);
-	memcpy(&wu->completeness_tag_numerator, message->buffer + 12, 4);
-	memcpy(&wu->completeness_tag_denominator, message->buffer + 16, 4);
+	unwrapWU(message, wu, 0);
 }
 
+void Serialization::unwrapWU(Message* message, WrapperUnit* wu, int index) {
+	if (index < 0 || index >= message->wrapper_length) {
+		stringstream ss;
+		ss << "[Serialization](unwrapWU) Wrapper unit index out of range : "
+				<< index << " (message has " << message->wrapper_length << ")";
+		throw ss.str();
+	}
+	*wu = MessageHeader::readWrapperUnit(message, index);
+}
+
+// a message may carry one wrapper unit per window it spans
 void Serialization::unwrap(Message* message) {//re-pointing the message variables to their respective positions
-	memcpy(&message->wrapper_length, message->buffer, 4);
+	const MessageHeader& header = MessageHeader::peek(message);
+
+	if (header.nof_wrapper_units < 0 || header.nof_wrapper_units > MAX_WRAPPER_SIZE
+			|| (size_t) message->size < header.payloadOffset()) {
+		stringstream ss;
+		ss << "[Serialization](unwrap) Invalid number of wrapper units : "
+				<< header.nof_wrapper_units << " for a message of size " << message->size;
+		throw ss.str();
+	}
+
+	message->wrapper_length = header.nof_wrapper_units;
 }
 
 void Serialization::YSBserializeFT(EventFT* event, Message* message) {
-	char* b = message->buffer + message->size;
-	memcpy(b, &event->event_time, 8);
-	b += 8;
-	memcpy(b, event->ad_id, 37);
-	message->size += sizeof(EventFT);
+	Codec<EventFT>::serialize(*event, message);
 }
 
 void Serialization::printWrapper(WrapperUnit* wc) {
@@ -155,153 +153,76 @@ void Serialization::printWrapper(WrapperUnit* wc) {
 
 void Serialization::YSBdeserializeFT(Message* message, EventFT* event,
 		int offset) {
-	char* b = message->buffer + offset;
-	memcpy(&event->event_time, b, 8);
-	b += 8;
-	memcpy(event->ad_id, b, 37);
+	Codec<EventFT>::deserialize(message, *event, offset);
 }
 
 void Serialization::YSBprintFT(EventFT* event) {
-	cout << "event_time: " << event->event_time << "\tad_id: " << event->ad_id
-			<< endl;
+	Codec<EventFT>::print(*event);
 }
 
 void Serialization::YSBserializeJ(EventJ* event, Message* message) {
-	char* b = message->buffer + message->size;
-	memcpy(b, &event->event_time, 8);
-	b += 8;
-	memcpy(b, event->c_id, 37);
-	message->size += sizeof(EventJ);
+	Codec<EventJ>::serialize(*event, message);
 }
 
 void Serialization::YSBdeserializeJ(Message* message, EventJ* event,
 		int offset) {
-	char* b = message->buffer + offset;
-	memcpy(&event->event_time, b, 8);
-	b += 8;
-	memcpy(event->c_id, b, 37);
+	Codec<EventJ>::deserialize(message, *event, offset);
 }
 
 void Serialization::YSBprintJ(EventJ* event) {
-	cout << "event_time: " << event->event_time << "\tc_id: " << event->c_id
-			<< endl;
+	Codec<EventJ>::print(*event);
 }
 
 void Serialization::YSBserializePA(EventPA* event, Message* message) {
-	char* b = message->buffer + message->size;
-	memcpy(b, &event->max_event_time, 8);
-	b += 8;
-	memcpy(b, &event->c_id, 8);
-	b += 8;
-	memcpy(b, &event->count, 4);
-	message->size += sizeof(EventPA);
+	Codec<EventPA>::serialize(*event, message);
 }
 
 void Serialization::YSBdeserializePA(Message* message, EventPA* event,
 		int offset) {
-	char* b = message->buffer + offset;
-	memcpy(&event->max_event_time, b, 8);
-	b += 8;
-	memcpy(&event->c_id, b, 8);
-	b += 8;
-	memcpy(&event->count, b, 4);
+	Codec<EventPA>::deserialize(message, *event, offset);
 }
 
 void Serialization::YSBprintPA(EventPA* event) {
-	cout << "__________________________________________" << endl;
-	cout << "max_event_time: " << event->max_event_time << endl;
-	cout << "c_id: " << event->c_id << endl;
-	cout << "count: " << event->count << endl;
+	Codec<EventPA>::print(*event);
 }
 
 void Serialization::YSBserializePC(EventPC* event, Message* message) {
-	char* b = message->buffer + message->size;
-	memcpy(b, &event->WID, 8);
-	b += 8;
-	memcpy(b, &event->c_id, 8);
-	b += 8;
-	memcpy(b, &event->count, 4);
-	b += 4;
-	memcpy(b, &event->latency, 4);
-	message->size += sizeof(EventPC);
+	Codec<EventPC>::serialize(*event, message);
 }
 
 void Serialization::YSBdeserializePC(Message* message, EventPC* event,
 		int offset) {
-	char* b = message->buffer + offset;
-	memcpy(&event->WID, b, 8);
-	b += 8;
-	memcpy(&event->c_id, b, 8);
-	b += 8;
-	memcpy(&event->count, b, 4);
-	b += 4;
-	memcpy(&event->latency, b, 4);
+	Codec<EventPC>::deserialize(message, *event, offset);
 }
 
 void Serialization::YSBprintPC(EventPC* event) {
-	cout << "__________________________________________" << endl;
-	cout << "WID: " << event->WID << endl;
-	cout << "c_id: " << event->c_id << endl;
-	cout << "count: " << event->count << endl;
-	cout << "latency: " << event->latency << endl;
+	Codec<EventPC>::print(*event);
 }
 
 void Serialization::YSBserializeIdCnt(IdCount* event, Message* message) {
-	char* b = message->buffer + message->size;
-	memcpy(b, &event->max_event_time, 8);
-	b += 8;
-	memcpy(b, &event->count, 8);
-	message->size += sizeof(IdCount);
+	Codec<IdCount>::serialize(*event, message);
 }
 
 void Serialization::YSBdeserializeIdCnt(Message* message, IdCount* event,
 		int offset) {
-	char* b = message->buffer + offset;
-	memcpy(&event->max_event_time, b, 8);
-	b += 8;
-	memcpy(&event->count, b, 8);
+	Codec<IdCount>::deserialize(message, *event, offset);
 }
 
 void Serialization::YSBprintIdCnt(IdCount* event) {
-	cout << "Max event time: " << event->max_event_time << "\t count: " << event->count
-			<< endl;
+	Codec<IdCount>::print(*event);
 }
 
 void Serialization::YSBserializePC_m(EventPC_m* event, Message* message) {
-	char* b = message->buffer + message->size;
-	memcpy(b, &event->WID, 8);
-	b += 8;
-	memcpy(b, &event->c_id, 8);
-	b += 8;
-	memcpy(b, &event->count, 4);
-	b += 4;
-	memcpy(b, &event->event_time, 8);
-	b += 8;
-	memcpy(b, &event->type, 4);
-	message->size += sizeof(EventPC_m);
+	Codec<EventPC_m>::serialize(*event, message);
 }
 
 void Serialization::YSBdeserializePC_m(Message* message, EventPC_m* event,
 		int offset) {
-	char* b = message->buffer + offset;
-	memcpy(&event->WID, b, 8);
-	b += 8;
-	memcpy(&event->c_id, b, 8);
-	b += 8;
-	memcpy(&event->count, b, 4);
-	b += 4;
-	memcpy(&event->event_time, b, 8);
-	b += 8;
-	memcpy(&event->type, b, 4);
+	Codec<EventPC_m>::deserialize(message, *event, offset);
 }
 
 void Serialization::YSBprintPC_m(EventPC_m* event) {
-	cout << "__________________________________________" << endl;
-	cout << "WID: " << event->WID << endl;
-	cout << "c_id: " << event->c_id << endl;
-	cout << "count: " << event->count << endl;
-	cout << "event_time: " << event->event_time << endl;
-	cout << "event_type: " << event->type << endl;
+	Codec<EventPC_m>::print(*event);
 }
 
 Message* Serialization::copy(Message*const src, const size_t offset){
@@ -35,6 +35,8 @@
 #define SERIALIZATION_SERIALIZATION_HPP_
 
 #include "../communication/Message.hpp"
+#include "../communication/MessageHeader.hpp"
+#include "Codec.hpp"
 #include "../communication/Window.hpp"
 #include "../partitioning/Partition.hpp"
 
@@ -74,6 +76,15 @@ typedef struct EventPC {
 	int latency;
 } EventPC;
 
+// summary of the results of a window, collected by rank 0 in SINK_DISTRIBUTED mode
+typedef struct WindowStats {
+	long int WID;
+	long int count; // sum of the counts of the window
+	long int sum_latency;
+	int nof_results; // number of EventPC of the window
+	int max_latency;
+} WindowStats;
+
 typedef struct IdCount {
 	long int max_event_time;
 	long int count;
@@ -87,6 +98,71 @@ typedef struct EventPC_m {
 	int type;
 } EventPC_m;
 
+// click-through rate of a campaign in a window, output of the YSB* join
+typedef struct EventCTR {
+	long int WID;
+	long int c_id;
+	int clicks;
+	int views;
+	double ctr;
+	long int latency;
+} EventCTR;
+
+// field lists used by the codecs (see Codec.hpp)
+
+RECORD_SCHEMA(EventDG,
+	RECORD_FIELD(EventDG, event_time),
+	RECORD_FIELD(EventDG, event_type),
+	RECORD_FIELD(EventDG, ad_id),
+	RECORD_FIELD(EventDG, userid_pageid_ipaddress))
+
+RECORD_SCHEMA(EventFT,
+	RECORD_FIELD(EventFT, event_time),
+	RECORD_FIELD(EventFT, ad_id))
+
+RECORD_SCHEMA(EventJ,
+	RECORD_FIELD(EventJ, event_time),
+	RECORD_FIELD(EventJ, c_id))
+
+RECORD_SCHEMA(EventPA,
+	RECORD_FIELD(EventPA, max_event_time),
+	RECORD_FIELD(EventPA, c_id),
+	RECORD_FIELD(EventPA, count))
+
+RECORD_SCHEMA(EventPC,
+	RECORD_FIELD(EventPC, WID),
+	RECORD_FIELD(EventPC, c_id),
+	RECORD_FIELD(EventPC, count),
+	RECORD_FIELD(EventPC, latency))
+
+RECORD_SCHEMA(WindowStats,
+	RECORD_FIELD(WindowStats, WID),
+	RECORD_FIELD(WindowStats, count),
+	RECORD_FIELD(WindowStats, sum_latency),
+	RECORD_FIELD(WindowStats, nof_results),
+	RECORD_FIELD(WindowStats, max_latency))
+
+RECORD_SCHEMA(IdCount,
+	RECORD_FIELD(IdCount, max_event_time),
+	RECORD_FIELD(IdCount, count))
+
+RECORD_SCHEMA(EventPC_m,
+	RECORD_FIELD(EventPC_m, WID),
+	RECORD_FIELD(EventPC_m, c_id),
+	RECORD_FIELD(EventPC_m, count),
+	RECORD_FIELD(EventPC_m, event_time),
+	RECORD_FIELD(EventPC_m, type))
+
+RECORD_SCHEMA(EventCTR,
+	RECORD_FIELD(EventCTR, WID),
+	RECORD_FIELD(EventCTR, c_id),
+	RECORD_FIELD(EventCTR, clicks),
+	RECORD_FIELD(EventCTR, views),
+	RECORD_FIELD(EventCTR, ctr),
+	RECORD_FIELD(EventCTR, latency))
+
+static_assert(sizeof(EventDG) == EVENT_SIZE, "EventDG doesn't match EVENT_SIZE");
+
 class Serialization {
 
 public:
@@ -112,9 +188,12 @@ public:
 
 	void unwrapFirstWU(Message* message, WrapperUnit* wu); //de-serializing the first wrapper-unit
 
+	void unwrapWU(Message* message, WrapperUnit* wu, int index); //de-serializing the index-th wrapper-unit (call unwrap first)
+
 	void printWrapper(WrapperUnit* wc);
 
 	//----for YSB----
+	// (wrappers around Codec<T>, kept for the existing operators)
 
 	void YSBserializeDG(EventDG* event, Message* message);
 
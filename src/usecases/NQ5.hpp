@@ -15,6 +15,16 @@ public:
 	static const int window_duration = 10; // 3600
 	static const int window_shift = 2; // 60
 
+	// number of auctions output per window (with ties), 1 for the hottest items only
+	static const int top_k = 1;
+
+	// early results of the next window to complete, before its final result :
+	// every early_firing_period seconds of processing time and/or every
+	// early_firing_messages input messages per rank (0 disables a trigger,
+	// both are disabled by default)
+	static const int early_firing_period = 0;
+	static const int early_firing_messages = 0;
+
 	NQ5(unsigned long tp);
 
 	~NQ5();
@@ -36,14 +36,14 @@
 #include "../nexmark_gen/EventGenerator.hpp"
 #include "../nexmark_hot_items_ws/EventCollector.hpp"
 #include "../nexmark_hot_items/BidFilter.hpp"
-#include "../nexmark_hot_items/EventSharder.hpp"
+#include "../nexmark_hot_items_ws/EventSharder.hpp"
 #include "../nexmark_hot_items_ws/GroupbyAuction.hpp"
 
 using nexmark::NQ5WS;
 using nexmark_gen::EventGenerator;
 using nexmark_hot_items::BidFilter;
 using nexmark_hot_items_ws::EventCollector;
-using nexmark_hot_items::EventSharder;
+using nexmark_hot_items_ws::EventSharder;
 using nexmark_hot_items_ws::GroupbyAuction;
 
 NQ5WS::NQ5WS(unsigned long throughput) :
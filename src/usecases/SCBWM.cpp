@@ -0,0 +1,27 @@
+#include "SCBWM.hpp"
+#include "../scb_wm/EventGenerator.hpp"
+#include "../scb_wm/Aggregator.hpp"
+#include "../scb_wm/EventCollector.hpp"
+
+using namespace scb_wm;
+
+SCBWM::SCBWM() : Dataflow() {
+
+	generator = new EventGenerator(1, rank, worldSize);
+	aggregator_watermark = new Aggregator(2, rank, worldSize);
+	collector = new EventCollector(3, rank, worldSize);
+
+	addLink(generator, aggregator_watermark);
+	addLink(aggregator_watermark, collector);
+
+	generator->initialize();
+	aggregator_watermark->initialize();
+	collector->initialize();
+}
+
+SCBWM::~SCBWM() {
+
+	delete generator;
+	delete aggregator_watermark;
+	delete collector;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "../dataflow/Dataflow.hpp"
+
+using namespace std;
+
+namespace scb_wm{
+class SCBWM: public Dataflow {
+
+public:
+
+	Vertex *generator, *aggregator_watermark, *collector;
+
+	SCBWM();
+
+	~SCBWM();
+
+	static const unsigned int window_duration = 2;
+	static const unsigned int aggregator_rank = 0;
+	static const int delay_probability = 10; // %
+	static const int delay_min_duration = 1; // s
+	static const int delay_max_duration = 4; // s
+	static const int allowed_lateness = 4; // s, windows are updated by late messages until then
+
+};
+};
@@ -39,6 +39,8 @@
 #include "../yahoo/FullAggregator.hpp"
 #include "../yahoo/PartialAggregator.hpp"
 #include "../yahoo/SHJoin.hpp"
+#include "../yahoo/SummaryCollector.hpp"
+#include "../dataflow/SinkTree.hpp"
 
 using namespace std;
 /**
@@ -60,7 +62,38 @@ YSB::YSB(unsigned long throughput) :
 	addLink(filter, join);
 	addLink(join, par_aggregate);
 	addLink(par_aggregate, full_aggregate);
-	addLink(full_aggregate, collector);
+
+	// results (SINK_TREE) or window summaries (SINK_DISTRIBUTED) reach rank 0
+	// through SinkTree::levels(worldSize) - 1 reducers
+	Vertex* sink = full_aggregate;
+	int tag = 7;
+
+	if (SINK_MODE == SINK_DISTRIBUTED) {
+		addLink(full_aggregate, collector);
+		sink = collector;
+	}
+
+	for (int level = 0;
+			SINK_MODE != SINK_ROOT && level < SinkTree::levels(worldSize) - 1;
+			level++) {
+		Vertex* reducer;
+		if (SINK_MODE == SINK_DISTRIBUTED)
+			reducer = new TreeReducer<WindowStats>(tag++, rank, worldSize, level);
+		else
+			reducer = new TreeReducer<EventPC>(tag++, rank, worldSize, level);
+
+		addLink(sink, reducer);
+		reducers.push_back(reducer);
+		sink = reducer;
+	}
+
+	if (SINK_MODE == SINK_DISTRIBUTED) {
+		summary_collector = new SummaryCollector(tag++, rank, worldSize);
+		addLink(sink, summary_collector);
+	} else {
+		summary_collector = NULL;
+		addLink(sink, collector);
+	}
 
 	generator->initialize();
 	filter->initialize();
@@ -68,6 +101,10 @@ YSB::YSB(unsigned long throughput) :
 	par_aggregate->initialize();
 	full_aggregate->initialize();
 	collector->initialize();
+	for (Vertex* reducer : reducers)
+		reducer->initialize();
+	if (summary_collector != NULL)
+		summary_collector->initialize();
 }
 
 YSB::~YSB() {
@@ -78,5 +115,8 @@ YSB::~YSB() {
 	delete par_aggregate;
 	delete full_aggregate;
 	delete collector;
+	for (Vertex* reducer : reducers)
+		delete reducer;
+	delete summary_collector;
 }
 
@@ -45,6 +45,10 @@ public:
 	Vertex *generator, *filter, *join, *par_aggregate, *full_aggregate,
 			*collector;
 
+	Vertex *summary_collector; // SINK_DISTRIBUTED mode only
+
+	vector<Vertex*> reducers; // inner nodes of the result collection tree
+
 	YSB(unsigned long tp);
 
 	~YSB();
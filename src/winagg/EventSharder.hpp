@@ -34,13 +34,66 @@
 #ifndef OPERATOR_EVENTSHARDER_HPP_
 #define OPERATOR_EVENTSHARDER_HPP_
 
-#include "../dataflow/Vertex.hpp"
+#include "../dataflow/KeyedWindowAggregator.hpp"
+#include "../communication/Window.hpp"
+#include "../serialization/Serialization.hpp"
 #include <string.h>
 #include <fstream>
 
 using namespace std;
 
-class EventSharder: public Vertex {
+/**
+ * Number of events and latest event time of a window, folded from the
+ * events by the sharders and from their partial counts by the counters.
+ */
+class EventCount {
+
+public:
+
+	void add(const EventDG& event) {
+		count++; // we could explicitly use the event count of the message here -- but, for a fair comparison with other implementations we preferred to parse the entire message!
+		max_event_time = max(max_event_time, event.event_time);
+	}
+
+	void add(const IdCount& partial) {
+		count += partial.count;
+		max_event_time = max(max_event_time, partial.max_event_time);
+	}
+
+	void merge(const EventCount& other) {
+		count += other.count;
+		max_event_time = max(max_event_time, other.max_event_time);
+	}
+
+	IdCount result() const {
+		return IdCount { max_event_time, count };
+	}
+
+	size_t size() const {
+		return count;
+	}
+
+private:
+
+	long int max_event_time = 0;
+	long int count = 0;
+};
+
+// tumbling windows of AGG_WIND_SPAN, a window is also the key of its count
+struct EventWindow {
+	long int operator()(const EventDG& event) const {
+		return event.event_time / AGG_WIND_SPAN;
+	}
+};
+
+typedef KeyedCombiner<EventDG, long int, EventCount, EventWindow, EventWindow> WindowCombiner;
+
+/**
+ * Counts the events of each message per window, and sends the counts to
+ * the rank of their window (WID % worldSize) with the wrapper units of the
+ * message, cf. KeyedCombiner.
+ */
+class EventSharder: public WindowCombiner {
 
 public:
 
@@ -48,9 +101,11 @@ public:
 
 	~EventSharder();
 
-	void batchProcess();
+protected:
+
+	vector<output_data> processMessage(message_ptr message);
 
-	void streamProcess(int channel);
+	WrapperUnit mapWrapperUnit(const WrapperUnit& unit);
 
 private:
 
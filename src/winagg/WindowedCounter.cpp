@@ -34,259 +34,46 @@
 #include "WindowedCounter.hpp"
 
 #include <mpi.h>
-#include <cstring>
 #include <iostream>
-#include <list>
-#include <unistd.h>
 
-#include "../communication/Message.hpp"
-#include "../communication/Window.hpp"
-#include "../serialization/Serialization.hpp"
+#include "../output/ResultSink.hpp"
 
 using namespace std;
 
 WindowedCounter::WindowedCounter(int tag, int rank, int worldSize) :
-		Vertex(tag, rank, worldSize) {
+		WindowCounts(tag, rank, worldSize) {
 	D(cout << "FULLAGGREGATOR [" << tag << "] CREATED @ " << rank << endl;);
-	pthread_mutex_init(&WID_to_Count_time_mutex, NULL);
-	pthread_mutex_init(&WIDtoWrapperUnit_mutex, NULL);
+	setBaseline('w');
 }
 
 WindowedCounter::~WindowedCounter() {
 	D(cout << "FULLAGGREGATOR [" << tag << "] DELETED @ " << rank << endl;);
 }
 
-void WindowedCounter::batchProcess() {
-	D(cout << "FULLAGGREGATOR->BATCHPROCESS [" << tag << "] @ " << rank << endl;);
+/**
+ * Messages are not counted with this baseline.
+ */
+int WindowedCounter::getMaxCompleteness() {
+	return 0;
 }
 
-void WindowedCounter::streamProcess(int channel) {
-
-	D(cout << "FULLAGGREGATOR->STREAMPROCESS [" << tag << "] @ " << rank
-			<< " IN-CHANNEL " << channel << endl;);
-
-	Message* inMessage, *outMessage;
-	list<Message*>* tmpMessages = new list<Message*>();
-	Serialization sede;
-
-	WIDtoWrapperUnitHMap::iterator WIDtoWrapperUnit_it;
-//	OuterHMap::iterator WIDtoIHM_it;
-	HMap::iterator WID_to_Count_time_it;
-
-	WrapperUnit wrapper_unit;
-	IdCount id_cnt;
-	EventPC eventPC;
-
-	long int win_time;
-
-	int c = 0;
-	while (ALIVE) {
-//		sleep(10);
-		int flag = 0;
-		pthread_mutex_lock(&listenerMutexes[channel]);
-
-		while (inMessages[channel].empty())
-			pthread_cond_wait(&listenerCondVars[channel],
-					&listenerMutexes[channel]);
-//		if (inMessages[channel].size() > 1) {
-//			flag = 1;
-//			cout << tag << " CHANNEL-" << channel << " BUFFER SIZE:"
-//					<< inMessages[channel].size() << endl;
-//		}
-
-		while (!inMessages[channel].empty()) {
-			inMessage = inMessages[channel].front();
-			inMessages[channel].pop_front();
-			tmpMessages->push_back(inMessage);
-		}
-
-		pthread_mutex_unlock(&listenerMutexes[channel]);
-
-//		if (flag == 1)
-//			cout << "CHANNEL-" << channel << " BUFFER SIZE:"
-//					<< tmpMessages->size() << endl;
-
-		while (!tmpMessages->empty()) {
-
-			inMessage = tmpMessages->front();
-			tmpMessages->pop_front();
-
-			D(cout << "WINCOUNTER->POP MESSAGE: TAG [" << tag << "] @ "
-					<< rank << " CHANNEL " << channel << " BUFFER "
-					<< inMessage->size << endl);
-
-			long int WID;
-			list<long int> completed_windows;
-
-			sede.unwrap(inMessage);
-			if (inMessage->wrapper_length > 0) {
-
-				sede.unwrapFirstWU(inMessage, &wrapper_unit);
-//				sede.printWrapper(&wrapper_unit);
-
-				WID = wrapper_unit.window_start_time / AGG_WIND_SPAN;
-
-				if (wrapper_unit.completeness_tag_denominator == 1) {
-					completed_windows.push_back(WID);
-				} else {
-					pthread_mutex_lock(&WIDtoWrapperUnit_mutex); //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-
-					if ((WIDtoWrapperUnit_it = WIDtoWrapperUnit.find(WID))
-							!= WIDtoWrapperUnit.end()) {
-
-						WIDtoWrapperUnit_it->second.first =
-								WIDtoWrapperUnit_it->second.first
-										+ wrapper_unit.completeness_tag_numerator;
-
-						//cout << "____AGGREGATE WRAPPER: " << WID << " NUM="
-						//		<< WIDtoWrapperUnit_it->second.first << " DEN="
-						//		<< WIDtoWrapperUnit_it->second.second << endl;
-
-						if (WIDtoWrapperUnit_it->second.first
-								/ WIDtoWrapperUnit_it->second.second) {
-							completed_windows.push_back(WID);
-							WIDtoWrapperUnit.erase(WID);
-							//cout << "____WID COMPLETE: " << WID << endl;
-						}
-
-					} else {
-
-						WIDtoWrapperUnit.emplace(WID,
-								make_pair(
-										wrapper_unit.completeness_tag_numerator,
-										wrapper_unit.completeness_tag_denominator));
-
-					}
-
-					pthread_mutex_unlock(&WIDtoWrapperUnit_mutex);//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
-				}
-			}
-
-			int offset = sizeof(int)
-					+ (inMessage->wrapper_length * sizeof(WrapperUnit));
-
-			outMessage = new Message(sizeof(IdCount)); // create new message with max. required capacity
-
-			int event_count = (inMessage->size - offset) / sizeof(IdCount);
-			//cout << "EVENT_COUNT: " << event_count << endl;
-
-			pthread_mutex_lock(&WID_to_Count_time_mutex); //===========================================================================
-
-			int i = 0, j = 0, k = 0;
-			sede.YSBdeserializeIdCnt(inMessage, &id_cnt, offset);
-
-			WID = id_cnt.max_event_time / AGG_WIND_SPAN;
-
-			if ((WID_to_Count_time_it = WID_to_Count_time.find(WID))
-					!= WID_to_Count_time.end()) {
-
-				win_time = (
-						WID_to_Count_time_it->second.second
-								> id_cnt.max_event_time ?
-								WID_to_Count_time_it->second.second :
-								id_cnt.max_event_time);
-
-				WID_to_Count_time_it->second = std::make_pair(
-						WID_to_Count_time_it->second.first + id_cnt.count,
-						win_time);
-
-//					cout<<"@ IF PART! ("<<WID_to_Count_time_it->first<<" , ("<<  WID_to_Count_time_it->second.first <<", "<<WID_to_Count_time_it->second.second<<")"<<endl;
-
-			} else { // new WID entry in the hashmap
-
-//					cout<<"@ ELSE PART!"<<endl;
-				WID_to_Count_time.emplace(WID,
-						std::make_pair(id_cnt.count, id_cnt.max_event_time));
-
-			}
-
-			i++;
-
-			long int time_now = (long int) (MPI_Wtime() * 1000.0);
-//			//cout << "\nFULLAGGR TIME_NOW:  " << time_now << endl;
-//			//printf("FULLAGGR MPI_Wtime: %lf\n", (MPI_Wtime() * 1000.0));
-//
-			while (!completed_windows.empty()) {
-//
-				WID = completed_windows.front();
-				completed_windows.pop_front();
-
-				WID_to_Count_time_it = WID_to_Count_time.find(WID);
-				if (WID_to_Count_time_it != WID_to_Count_time.end()) {
-//
-//					j = 0;
-//					for (CIDtoCountAndMaxEventTime_it =
-//							WIDtoIHM_it->second.begin();
-//							CIDtoCountAndMaxEventTime_it
-//									!= WIDtoIHM_it->second.end();
-//							CIDtoCountAndMaxEventTime_it++) {
-//
-					eventPC.WID = WID;
-//						eventPC.c_id = CIDtoCountAndMaxEventTime_it->first;
-					eventPC.count = WID_to_Count_time_it->second.first;
-					eventPC.latency = (time_now
-							- WID_to_Count_time_it->second.second);
-//
-//						cout << "  " << j << "\tWID: " << eventPC.WID
-////								<< "\tc_id: " << eventPC.c_id << "\tcount: "
-					cout << "\tWID: " << eventPC.WID <<"\tCOUNT: "<< eventPC.count
-							<< "\tLATENCY: " << eventPC.latency
-//								<< " SIZE "
-////								<< outMessage->size << " CAP "
-////								<< outMessage->capacity
-							<< endl;
-//
-//						sede.YSBserializePC(&eventPC, outMessage);
-//						//sede.YSBdeserializePC(outMessage, &eventPC,
-//						//		outMessage->size - sizeof(EventPC));
-//						//sede.YSBprintPC(&eventPC);
-//						j++;
-//					}
-//
-//					WIDtoIHM_it->second.clear(); // clear inner map
-					WID_to_Count_time.erase(WID); // remove from outer map
-				}
-			}
-
-			pthread_mutex_unlock(&WID_to_Count_time_mutex); //====================================================================
-
-			// Finally send message to a single collector on rank 0
-			int n = 0;
-			for (vector<Vertex*>::iterator v = next.begin(); v != next.end();
-					++v) {
-
-				if (outMessage->size > 0) {
-
-					int idx = n * worldSize + 0; // send to rank 0 only
-
-					// Normal mode: synchronize on outgoing message channel & send message
-					pthread_mutex_lock(&senderMutexes[idx]);
-					outMessages[idx].push_back(outMessage);
-
-					D(cout << "FULLAGGREGATOR->PUSHBACK MESSAGE [" << tag << "] #"
-							<< c << " @ " << rank << " IN-CHANNEL " << channel
-							<< " OUT-CHANNEL " << idx << " SIZE "
-							<< outMessage->size << " CAP "
-							<< outMessage->capacity << endl;);
-
-					pthread_cond_signal(&senderCondVars[idx]);
-					pthread_mutex_unlock(&senderMutexes[idx]);
-
-				} else {
-
-					delete outMessage;
-				}
+/**
+ * The counts stay on this rank : the window is printed (if this rank owns
+ * it) and nothing is sent.
+ */
+vector<output_data> WindowedCounter::processWindow(const Keyed& accumulator) {
 
-				n++;
-				break; // only one successor node allowed!
-			}
+	long int time_now = (long int) (MPI_Wtime() * 1000.0);
 
-			delete inMessage;
-			c++;
-		}
+	accumulator.forEach([time_now](const long int WID, const EventCount& counts) {
+		const IdCount window = counts.result();
 
-		tmpMessages->clear();
-	}
+		stringstream line;
+		line << "\tWID: " << WID << "\tCOUNT: " << window.count
+				<< "\tLATENCY: " << (time_now - window.max_event_time)
+				<< '\n';
+		ResultSink::console().print(line.str());
+	});
 
-	delete tmpMessages;
+	return vector<output_data>();
 }
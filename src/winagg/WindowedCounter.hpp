@@ -34,35 +34,32 @@
 #ifndef OPERATOR_WIN_COUNTER_HPP_
 #define OPERATOR_WIN_COUNTER_HPP_
 
-#include <unordered_map>
-#include <utility>
-
-#include "../dataflow/Vertex.hpp"
+#include "../dataflow/FlowWrappingAggregator.hpp"
+#include "../dataflow/KeyedWindowAggregator.hpp"
+#include "EventSharder.hpp"
 
 using namespace std;
 
+typedef KeyedWindowAggregator<long int, IdCount, EventCount, KeyWindows, FlowWrappingAggregator> WindowCounts;
 
-typedef unordered_map<long int, std::pair<long int, long int> > HMap;
-//typedef unordered_map<long int, unordered_map<long int, count_maxeventtime>> OuterHMap;
-typedef unordered_map<long int, std::pair<int, int>> WIDtoWrapperUnitHMap;
-
-class WindowedCounter: public Vertex {
+/**
+ * Final stage of the window counts : adds the partial counts of the
+ * sharders, and prints the count of a window once its wrapper units are
+ * complete.
+ */
+class WindowedCounter: public WindowCounts {
 
 public:
 
-	HMap WID_to_Count_time;
-	pthread_mutex_t WID_to_Count_time_mutex;
-
-	WIDtoWrapperUnitHMap WIDtoWrapperUnit;
-	pthread_mutex_t WIDtoWrapperUnit_mutex;
-
 	WindowedCounter(int tag, int rank, int worldSize);
 
 	~WindowedCounter();
 
-	void batchProcess();
+protected:
+
+	int getMaxCompleteness();
 
-	void streamProcess(int channel);
+	vector<output_data> processWindow(const Keyed& accumulator);
 
 };
 
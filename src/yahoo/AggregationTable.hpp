@@ -0,0 +1,361 @@
+/**
+ * Copyright (c) 2020 University of Luxembourg. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF LUXEMBOURG AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE UNIVERSITY OF LUXEMBOURG OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+/*
+ * AggregationTable.hpp
+ */
+
+#ifndef YAHOO_AGGREGATIONTABLE_HPP_
+#define YAHOO_AGGREGATIONTABLE_HPP_
+
+#include <climits>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "../communication/Window.hpp"
+#include "../serialization/Serialization.hpp"
+
+using namespace std;
+
+/**
+ * Count and max. event time per campaign id, for a single window.
+ *
+ * Open addressing with linear probing over a power-of-two number of slots,
+ * the columns are stored separately (keys, counts, max. event times) so that
+ * probing only touches the keys. The table only allocates when it grows,
+ * clear() keeps its capacity for the next window.
+ */
+class CampaignTable {
+
+public:
+
+	CampaignTable(size_t capacity = 128);
+
+	void add(long int c_id, int count, long int max_event_time);
+
+	void merge(const CampaignTable& other);
+
+	void clear();
+
+	bool empty() const;
+
+	size_t size() const;
+
+	// calls f(c_id, count, max_event_time) for every campaign of the table
+	template<typename F>
+	void forEach(F f) const;
+
+private:
+
+	static const long int EMPTY_KEY = LONG_MIN;
+
+	vector<long int> keys;
+
+	vector<int> counts;
+
+	vector<long int> max_event_times;
+
+	size_t mask; // number of slots - 1
+
+	size_t nof_keys;
+
+	size_t slot(long int c_id) const;
+
+	void grow();
+};
+
+inline CampaignTable::CampaignTable(size_t capacity) {
+	size_t slots = 16;
+	while (slots < capacity * 2) // keep the load factor under 0.5
+		slots *= 2;
+
+	keys.assign(slots, (long int) EMPTY_KEY);
+	counts.assign(slots, 0);
+	max_event_times.assign(slots, 0);
+	mask = slots - 1;
+	nof_keys = 0;
+}
+
+/**
+ * Returns the slot of the campaign, or the empty slot where it should be inserted.
+ */
+inline size_t CampaignTable::slot(long int c_id) const {
+	size_t i = ((unsigned long) c_id * 0x9E3779B97F4A7C15UL) >> 32 & mask; // fibonacci hashing
+	while (keys[i] != c_id && keys[i] != EMPTY_KEY)
+		i = (i + 1) & mask;
+	return i;
+}
+
+inline void CampaignTable::add(long int c_id, int count,
+		long int max_event_time) {
+	size_t i = slot(c_id);
+
+	if (keys[i] == EMPTY_KEY) {
+		if ((nof_keys + 1) * 2 > keys.size()) {
+			grow();
+			i = slot(c_id);
+		}
+		keys[i] = c_id;
+		counts[i] = 0;
+		max_event_times[i] = max_event_time;
+		nof_keys++;
+	}
+
+	counts[i] += count;
+	if (max_event_times[i] < max_event_time) // new max. event time!
+		max_event_times[i] = max_event_time;
+}
+
+inline void CampaignTable::merge(const CampaignTable& other) {
+	for (size_t i = 0; i < other.keys.size(); i++) {
+		if (other.keys[i] != EMPTY_KEY)
+			add(other.keys[i], other.counts[i], other.max_event_times[i]);
+	}
+}
+
+inline void CampaignTable::clear() {
+	if (nof_keys > 0) {
+		keys.assign(keys.size(), (long int) EMPTY_KEY);
+		nof_keys = 0;
+	}
+}
+
+inline bool CampaignTable::empty() const {
+	return nof_keys == 0;
+}
+
+inline size_t CampaignTable::size() const {
+	return nof_keys;
+}
+
+inline void CampaignTable::grow() {
+	CampaignTable grown(keys.size());
+	grown.merge(*this);
+	*this = std::move(grown);
+}
+
+template<typename F>
+void CampaignTable::forEach(F f) const {
+	for (size_t i = 0; i < keys.size(); i++) {
+		if (keys[i] != EMPTY_KEY)
+			f(keys[i], counts[i], max_event_times[i]);
+	}
+}
+
+/**
+ * Small table of the active windows: the state of a window is found from the
+ * slot WID % number of slots, consecutive windows take consecutive slots.
+ * Collisions (e.g. with a window that never completes) are resolved by
+ * linear probing, erased windows leave a tombstone so that the states never
+ * move while they are used. Slots and their states are reused from one
+ * window to the next, the table only allocates when it grows.
+ *
+ * T must be default constructible and provide a clear() method, which is
+ * called when a window is erased.
+ */
+template<typename T>
+class WindowTable {
+
+public:
+
+	WindowTable(size_t nof_slots = 8);
+
+	T& get(long int WID); // creates the window if it is not active yet
+
+	T* find(long int WID);
+
+	void erase(long int WID);
+
+	// calls f(WID, state) for every active window, f may erase the window
+	template<typename F>
+	void forEach(F f);
+
+	template<typename F>
+	void forEach(F f) const;
+
+private:
+
+	static const long int NO_WINDOW = LONG_MIN;
+
+	static const long int ERASED = LONG_MIN + 1;
+
+	vector<long int> WIDs;
+
+	vector<T> states;
+
+	size_t mask; // number of slots - 1
+
+	size_t nof_used; // active windows and tombstones
+
+	size_t slot(long int WID) const;
+
+	void rehash(size_t nof_slots);
+};
+
+template<typename T>
+const long int WindowTable<T>::NO_WINDOW;
+
+template<typename T>
+const long int WindowTable<T>::ERASED;
+
+template<typename T>
+WindowTable<T>::WindowTable(size_t nof_slots) {
+	size_t slots = 2;
+	while (slots < nof_slots)
+		slots *= 2;
+
+	WIDs.assign(slots, (long int) NO_WINDOW);
+	states.resize(slots);
+	mask = slots - 1;
+	nof_used = 0;
+}
+
+/**
+ * Returns the slot of the window, or the empty slot ending its probe sequence.
+ */
+template<typename T>
+size_t WindowTable<T>::slot(long int WID) const {
+	size_t i = (unsigned long) WID & mask;
+	while (WIDs[i] != WID && WIDs[i] != NO_WINDOW)
+		i = (i + 1) & mask;
+	return i;
+}
+
+template<typename T>
+T& WindowTable<T>::get(long int WID) {
+	size_t i = (unsigned long) WID & mask;
+	size_t erased = WIDs.size(); // first tombstone of the probe sequence
+
+	while (WIDs[i] != WID && WIDs[i] != NO_WINDOW) {
+		if (WIDs[i] == ERASED && erased == WIDs.size())
+			erased = i;
+		i = (i + 1) & mask;
+	}
+
+	if (WIDs[i] == NO_WINDOW && erased != WIDs.size()) {
+		// reuse the slot (and the state) of an erased window
+		WIDs[erased] = WID;
+		return states[erased];
+	}
+
+	if (WIDs[i] == NO_WINDOW) {
+		if ((nof_used + 1) * 2 > WIDs.size()) {
+			rehash(WIDs.size());
+			i = slot(WID);
+		}
+		WIDs[i] = WID;
+		nof_used++;
+	}
+
+	return states[i];
+}
+
+template<typename T>
+T* WindowTable<T>::find(long int WID) {
+	size_t i = slot(WID);
+	return WIDs[i] == WID ? &states[i] : nullptr;
+}
+
+template<typename T>
+void WindowTable<T>::erase(long int WID) {
+	size_t i = slot(WID);
+	if (WIDs[i] == WID) {
+		WIDs[i] = ERASED;
+		states[i].clear();
+	}
+}
+
+/**
+ * Drops the tombstones, and doubles the number of slots as long as the
+ * active windows take more than half of them.
+ */
+template<typename T>
+void WindowTable<T>::rehash(size_t nof_slots) {
+	size_t nof_windows = 0;
+	for (size_t i = 0; i < WIDs.size(); i++) {
+		if (WIDs[i] != NO_WINDOW && WIDs[i] != ERASED)
+			nof_windows++;
+	}
+
+	while ((nof_windows + 1) * 2 > nof_slots)
+		nof_slots *= 2;
+
+	vector<long int> old_WIDs(nof_slots, (long int) NO_WINDOW);
+	vector<T> old_states(nof_slots);
+	old_WIDs.swap(WIDs);
+	old_states.swap(states);
+	mask = nof_slots - 1;
+	nof_used = nof_windows;
+
+	for (size_t i = 0; i < old_WIDs.size(); i++) {
+		if (old_WIDs[i] == NO_WINDOW || old_WIDs[i] == ERASED)
+			continue;
+		size_t j = slot(old_WIDs[i]);
+		WIDs[j] = old_WIDs[i];
+		states[j] = std::move(old_states[i]);
+	}
+}
+
+template<typename T>
+template<typename F>
+void WindowTable<T>::forEach(F f) {
+	for (size_t i = 0; i < WIDs.size(); i++) {
+		if (WIDs[i] != NO_WINDOW && WIDs[i] != ERASED)
+			f(WIDs[i], states[i]);
+	}
+}
+
+template<typename T>
+template<typename F>
+void WindowTable<T>::forEach(F f) const {
+	for (size_t i = 0; i < WIDs.size(); i++) {
+		if (WIDs[i] != NO_WINDOW && WIDs[i] != ERASED)
+			f(WIDs[i], states[i]);
+	}
+}
+
+/**
+ * Adds a batch of partial aggregates to the tables of their windows.
+ */
+inline void aggregate(WindowTable<CampaignTable>& windows,
+		const EventPA* events, size_t nof_events) {
+	long int WID = LONG_MIN;
+	CampaignTable* table = nullptr;
+
+	for (size_t i = 0; i < nof_events; i++) {
+		const EventPA& eventPA = events[i];
+
+		if (eventPA.max_event_time / AGG_WIND_SPAN != WID) { // usually the same window
+			WID = eventPA.max_event_time / AGG_WIND_SPAN;
+			table = &windows.get(WID);
+		}
+
+		table->add(eventPA.c_id, eventPA.count, eventPA.max_event_time);
+	}
+}
+
+#endif /* YAHOO_AGGREGATIONTABLE_HPP_ */
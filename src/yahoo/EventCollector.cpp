@@ -34,6 +34,8 @@
 #include <unistd.h>
 #include "../serialization/Serialization.hpp"
 #include "EventCollector.hpp"
+#include "../dataflow/SinkTree.hpp"
+#include "../output/ResultSink.hpp"
 
 
 using namespace std;
@@ -46,7 +48,7 @@ EventCollector::EventCollector(int tag, int rank, int worldSize) :
 	sum_counts = 0;
 	num_messages = 0;
 
-	S_CHECK(if (rank == 0) {
+	S_CHECK(if (rank == 0 || SINK_MODE == SINK_DISTRIBUTED) {
 				datafile.open("Data/results"+to_string(rank)+".tsv");
 	})
 
@@ -67,13 +69,11 @@ void EventCollector::streamProcess(int channel) {
 	D(cout << "EVENTCOLLECTOR->STREAMPROCESS [" << tag << "] @ " << rank
 			<< " IN-CHANNEL " << channel << endl;)
 
-	if (rank == 0) {
+	// in SINK_DISTRIBUTED mode, every rank collects the windows it aggregated
+	if (rank == 0 || SINK_MODE == SINK_DISTRIBUTED) {
 
 		Message* inMessage;
 		list<Message*>* tmpMessages = new list<Message*>();
-		Serialization sede;
-
-		EventPC eventPC;
 
 		int c = 0;
 		while (ALIVE) {
@@ -101,16 +101,23 @@ void EventCollector::streamProcess(int channel) {
 						<< rank << " CHANNEL " << channel << " BUFFER "
 						<< inMessage->size << endl;)
 
-				int event_count = inMessage->size / sizeof(EventPC);
+				vector<EventPC> events = Codec<EventPC>::decode(inMessage, 0);
+				int event_count = events.size();
 				//cout << "EVENT_COUNT: " << event_count << endl;
 
+				if (SINK_MODE == SINK_DISTRIBUTED) {
+					summarize(events);
+
+					delete inMessage;
+					c++;
+					continue;
+				}
+
 				int i = 0, count = 0;
 				while (i < event_count) {
-					sede.YSBdeserializePC(inMessage, &eventPC,
-							i * sizeof(EventPC));
+					const EventPC& eventPC = events[i];
 					sum_latency += eventPC.latency;
 					count += eventPC.count;
-//					sede.YSBprintPC(&eventPC);
 					S_CHECK(
 										datafile
 												<< eventPC.WID << "\t"
@@ -124,9 +131,11 @@ void EventCollector::streamProcess(int channel) {
 				sum_counts += event_count; // count of distinct c_id's processed
 				num_messages++;
 
-				cout << "\n  #" << num_messages << " COUNT: " << count
+				stringstream line;
+				line << "\n  #" << num_messages << " COUNT: " << count
 						<< "\tAVG_LATENCY: " << (sum_latency / sum_counts)
-						<< "\tN=" << event_count << "\n" << endl;
+						<< "\tN=" << event_count << "\n\n";
+				ResultSink::console().print(line.str());
 
 
 				delete inMessage; // delete message from incoming queue
@@ -139,3 +148,56 @@ void EventCollector::streamProcess(int channel) {
 		delete tmpMessages;
 	}
 }
+
+/**
+ * SINK_DISTRIBUTED mode: the results stay on this rank, only one WindowStats
+ * per window is sent to rank 0, through the reduction tree (see SinkTree).
+ */
+void EventCollector::summarize(const vector<EventPC>& events) {
+
+	vector<WindowStats> summaries; // usually a single window per message
+
+	for (const EventPC& eventPC : events) {
+
+		S_CHECK(
+				datafile
+						<< eventPC.WID << "\t"
+						<< eventPC.c_id << "\t"
+						<< eventPC.count
+						<<endl;
+		)
+
+		size_t i = 0;
+		while (i < summaries.size() && summaries[i].WID != eventPC.WID)
+			i++;
+
+		if (i == summaries.size()) {
+			WindowStats summary;
+			summary.WID = eventPC.WID;
+			summary.count = 0;
+			summary.sum_latency = 0;
+			summary.nof_results = 0;
+			summary.max_latency = 0;
+			summaries.push_back(summary);
+		}
+
+		WindowStats& summary = summaries[i];
+		summary.count += eventPC.count;
+		summary.sum_latency += eventPC.latency;
+		summary.nof_results++;
+		summary.max_latency = max(summary.max_latency, eventPC.latency);
+	}
+
+	if (summaries.empty() || next.empty())
+		return;
+
+	Message* outMessage = new Message(summaries.size() * sizeof(WindowStats));
+	Codec<WindowStats>::encode(summaries, outMessage);
+
+	int idx = SinkTree::parent(rank, 0); // only one successor node allowed!
+
+	pthread_mutex_lock(&senderMutexes[idx]);
+	outMessages[idx].push_back(outMessage);
+	pthread_cond_signal(&senderCondVars[idx]);
+	pthread_mutex_unlock(&senderMutexes[idx]);
+}
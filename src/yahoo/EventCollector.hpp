@@ -60,6 +60,8 @@ public:
 private:
 	std::ofstream datafile;
 
+	void summarize(const vector<EventPC>& events);
+
 };
 
 #endif /* COLLECTOR_EVENTCOLLECTOR_HPP_ */
@@ -50,12 +50,14 @@ using namespace std;
 EventFilter::EventFilter(int tag, int rank, int worldSize) :
 		Vertex(tag, rank, worldSize) {
 	D(cout << "EVENTFILTER [" << tag << "] CREATED @ " << rank << endl;)
+	pthread_mutex_init(&datafile_mutex, NULL);
 	THROUGHPUT_LOG(
 			datafile.open("Data/tp_log"+ to_string(rank) + ".tsv");
 	)
 }
 
 EventFilter::~EventFilter() {
+	pthread_mutex_destroy(&datafile_mutex);
 	D(cout << "EVENTFILTER [" << tag << "] DELETED @ " << rank << endl;)
 }
 
@@ -63,19 +65,23 @@ void EventFilter::batchProcess() {
 	cout << "EVENTFILTER->BATCHPROCESS [" << tag << "] @ " << rank << endl;
 }
 
+bool EventFilter::isChainable() {
+	return true;
+}
+
+bool EventFilter::isForward() {
+	return true; // always keep workload on same rank
+}
+
 void EventFilter::streamProcess(int channel) {
 
 	D(cout << "EVENTFILTER->STREAMPROCESS [" << tag << "] @ " << rank
 			<< " IN-CHANNEL " << channel << endl;)
 
-	Message* inMessage, *outMessage;
+	Message* inMessage;
 	list<Message*>* tmpMessages = new list<Message*>();
 	Serialization sede;
 
-	//WrapperUnit wrapper_unit;
-	EventDG eventDG;
-	EventFT eventFT;
-
 	int c = 0;
 
 	while (ALIVE) {
@@ -113,99 +119,120 @@ void EventFilter::streamProcess(int channel) {
 			//	sede.printWrapper(&wrapper_unit);
 			//}
 
-			int offset = sizeof(int)
-					+ (inMessage->wrapper_length * sizeof(WrapperUnit));
+			// the events are read in place from the message
+			processBatch(RecordBatch::of<EventDG>(inMessage), channel);
+
+			delete inMessage;
+			c++;
+		}
+
+		tmpMessages->clear();
+	}
+
+	delete tmpMessages;
+}
+
+/**
+ * Filters the events of the batch, then hands the filtered events over to
+ * the chained successor, or sends them in a message with the same header.
+ */
+void EventFilter::processBatch(const RecordBatch& batch, int channel) {
 
-			outMessage = new Message(inMessage->size - offset,
-					inMessage->wrapper_length); // create new message with max. required capacity
+	const EventDG* events = batch.as<EventDG>();
+	int event_count = batch.count;
 
-			memcpy(outMessage->buffer, inMessage->buffer, offset); // simply copy header from old message for now!
-			outMessage->size += offset;
+	D(cout << "THROUGHPUT: " << event_count <<" @RANK-"<<rank<<" TIME: "<<(long int)MPI_Wtime()<< endl;)
 
-			int event_count = (inMessage->size - offset) / sizeof(EventDG);
+	THROUGHPUT_LOG(
+			pthread_mutex_lock(&datafile_mutex);
+			datafile <<event_count<< "\t"
+			<<rank<< "\t"
+			<<(long int)MPI_Wtime()
+			<< endl;
+			pthread_mutex_unlock(&datafile_mutex);
+			)
 
-			D(cout << "THROUGHPUT: " << event_count <<" @RANK-"<<rank<<" TIME: "<<(long int)MPI_Wtime()<< endl;)
+	vector<EventFT> filtered;
+	filtered.reserve(event_count);
 
-			THROUGHPUT_LOG(
-					datafile <<event_count<< "\t"
-					<<rank<< "\t"
-					<<(long int)MPI_Wtime()
-					<< endl;
-					)
+	EventFT eventFT;
 
+	int i = 0;
+	while (i < event_count) {
 
-			int i = 0, j = 0;
-			while (i < event_count) {
+		const EventDG& eventDG = events[i];
 
-				sede.YSBdeserializeDG(inMessage, &eventDG,
-						offset + (i * sizeof(EventDG)));
+		D(cout << "  " << i << "\tevent_time: " << eventDG.event_time
+				<< "\tevent_type: " << eventDG.event_type << "\t"
+				<< "ad_id: " << eventDG.ad_id << endl;)
 
-				D(cout << "  " << i << "\tevent_time: " << eventDG.event_time
-						<< "\tevent_type: " << eventDG.event_type << "\t"
-						<< "ad_id: " << eventDG.ad_id << endl;)
+		if (strcmp(eventDG.event_type, "click")==0) { //FILTERING BASED ON EVENT_TYPE
+			eventFT.event_time = eventDG.event_time;
+			memcpy(eventFT.ad_id, eventDG.ad_id, 37);
+			filtered.push_back(eventFT);
+		}
 
-				if (strcmp(eventDG.event_type, "click")==0) { //FILTERING BASED ON EVENT_TYPE
-					eventFT.event_time = eventDG.event_time;
-					memcpy(eventFT.ad_id, eventDG.ad_id, 37);
-					sede.YSBserializeFT(&eventFT, outMessage); // store filtered events directly in outgoing message!
-//					sede.YSBdeserializeFT(outMessage, &eventFT,
-//							outMessage->size - sizeof(EventFT));
-//					sede.YSBprintFT(&eventFT);
-					j++;
-				}
+		i++;
+	}
+	//cout << "FILTERED_EVENT_COUNT: " << filtered.size() << endl;
+
+	if (chainedNext != nullptr) {
+		// Chained mode: the successor runs on this thread, no message needed
+		chainedNext->processBatch(
+				RecordBatch(batch.origin, filtered.data(), filtered.size()),
+				channel);
+		return;
+	}
 
-				i++;
-			}
-			//cout << "FILTERED_EVENT_COUNT: " << j << endl;
+	int offset = MessageHeader::length(batch.origin->wrapper_length);
 
-			// Replicate data to all subsequent vertices, do not actually reshard the data here
-			int n = 0;
-			for (vector<Vertex*>::iterator v = next.begin(); v != next.end();
-					++v) {
+	Message* outMessage = new Message(filtered.size() * sizeof(EventFT),
+			batch.origin->wrapper_length);
 
-				int idx = n * worldSize + rank; // always keep workload on same rank
+	memcpy(outMessage->buffer, batch.origin->buffer, offset); // simply copy header from old message for now!
+	outMessage->size += offset;
 
-				if (PIPELINE) {
+	Codec<EventFT>::encode(filtered, outMessage); // store filtered events directly in outgoing message!
 
-					// Pipeline mode: immediately copy message into next operator's queue
-					pthread_mutex_lock(&(*v)->listenerMutexes[idx]);
-					(*v)->inMessages[idx].push_back(outMessage);
+	// Replicate data to all subsequent vertices, do not actually reshard the data here
+	int n = 0;
+	for (vector<Vertex*>::iterator v = next.begin(); v != next.end();
+			++v) {
 
-					D(cout << "EVENTFILTER->PIPELINE MESSAGE [" << tag << "] #"
-							<< c << " @ " << rank << " IN-CHANNEL " << channel
-							<< " OUT-CHANNEL " << idx << " SIZE "
-							<< outMessage->size << " CAP "
-							<< outMessage->capacity << endl;)
+		int idx = n * worldSize + rank; // always keep workload on same rank
 
-					pthread_cond_signal(&(*v)->listenerCondVars[idx]);
-					pthread_mutex_unlock(&(*v)->listenerMutexes[idx]);
+		if (PIPELINE) {
 
-				} else {
+			// Pipeline mode: immediately copy message into next operator's queue
+			pthread_mutex_lock(&(*v)->listenerMutexes[idx]);
+			(*v)->inMessages[idx].push_back(outMessage);
 
-					// Normal mode: synchronize on outgoing message channel & send message
-					pthread_mutex_lock(&senderMutexes[idx]);
-					outMessages[idx].push_back(outMessage);
+			D(cout << "EVENTFILTER->PIPELINE MESSAGE [" << tag << "] @ "
+					<< rank << " IN-CHANNEL " << channel
+					<< " OUT-CHANNEL " << idx << " SIZE "
+					<< outMessage->size << " CAP "
+					<< outMessage->capacity << endl;)
 
-					D(cout << "EVENTFILTER->PUSHBACK MESSAGE [" << tag << "] #"
-							<< c << " @ " << rank << " IN-CHANNEL " << channel
-							<< " OUT-CHANNEL " << idx << " SIZE "
-							<< outMessage->size << " CAP "
-							<< outMessage->capacity << endl;)
+			pthread_cond_signal(&(*v)->listenerCondVars[idx]);
+			pthread_mutex_unlock(&(*v)->listenerMutexes[idx]);
 
-					pthread_cond_signal(&senderCondVars[idx]);
-					pthread_mutex_unlock(&senderMutexes[idx]);
-				}
+		} else {
 
-				n++;
-				break; // only one successor node allowed!
-			}
+			// Normal mode: synchronize on outgoing message channel & send message
+			pthread_mutex_lock(&senderMutexes[idx]);
+			outMessages[idx].push_back(outMessage);
 
-			delete inMessage;
-			c++;
+			D(cout << "EVENTFILTER->PUSHBACK MESSAGE [" << tag << "] @ "
+					<< rank << " IN-CHANNEL " << channel
+					<< " OUT-CHANNEL " << idx << " SIZE "
+					<< outMessage->size << " CAP "
+					<< outMessage->capacity << endl;)
+
+			pthread_cond_signal(&senderCondVars[idx]);
+			pthread_mutex_unlock(&senderMutexes[idx]);
 		}
 
-		tmpMessages->clear();
+		n++;
+		break; // only one successor node allowed!
 	}
-
-	delete tmpMessages;
 }
@@ -52,9 +52,16 @@ public:
 
 	void streamProcess(int channel);
 
+	bool isChainable();
+
+	bool isForward();
+
+	void processBatch(const RecordBatch& batch, int channel);
+
 private:
 
 	std::ofstream datafile;
+	pthread_mutex_t datafile_mutex; // the chained generator threads share the log
 
 };
 
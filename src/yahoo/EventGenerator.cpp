@@ -32,6 +32,7 @@
  */
 
 #include <mpi.h>
+#include <algorithm>
 #include <unistd.h>
 #include <cstdio>
 #include <cstdlib>
@@ -40,23 +41,46 @@
 #include <iostream>
 #include <iterator>
 #include <list>
+#include <sstream>
 #include <string>
 #include <vector>
 
 #include "../communication/Window.hpp"
+#include "../output/ResultSink.hpp"
 #include "EventGenerator.hpp"
 
 using namespace std;
 
 EventGenerator::EventGenerator(int tag, int rank, int worldSize,
 		unsigned long tp) :
-		Vertex(tag, rank, worldSize) {
+		Vertex(tag, rank, worldSize), start_time(0), start_wtime(0), events_generated(
+				0) {
 	this->throughput = tp;
 	std::ifstream ifile("../data/YSB_data/ad_ids.txt");
 	for (std::string line; getline(ifile, line);) {
 		ad_ids.push_back(line);
 	}
 
+	if (ad_ids.empty()) {
+		throw "[EventGenerator] No ad_id found in ../data/YSB_data/ad_ids.txt";
+	}
+
+	EventDG event;
+	memset(&event, 0, sizeof(EventDG));
+	memcpy(event.userid_pageid_ipaddress,
+			"7ad5154e-b296-4b07-9cb8-15bb6a395b2f,328df5ff-0e4a-4f8e-b3ea-5c35d6a3fb3b,1.2.3.4\0",
+			82); //default values that are used for all the events
+
+	for (const string& event_type : eventtypes) {
+		for (const string& ad_id : ad_ids) {
+			strncpy(event.event_type, event_type.c_str(), sizeof(event.event_type));
+			memcpy(event.ad_id, ad_id.c_str(), 36);
+			templates.push_back(event);
+		}
+	}
+
+	pthread_mutex_init(&datafile_mutex, NULL);
+
 	cout << "AIR INSTANCE AT RANK " << (rank + 1) << "/" << worldSize << " | TP: " << throughput << " | MSG/SEC/RANK: " << PER_SEC_MSG_COUNT << " | AGGR_WINDOW: " << AGG_WIND_SPAN << "ms" << endl;
 
 	S_CHECK(
@@ -67,6 +91,7 @@ EventGenerator::EventGenerator(int tag, int rank, int worldSize,
 }
 
 EventGenerator::~EventGenerator() {
+	pthread_mutex_destroy(&datafile_mutex);
 	D(cout << "EVENTGENERATOR [" << tag << "] DELTETED @ " << rank << endl;)
 }
 
@@ -77,6 +102,14 @@ void EventGenerator::batchProcess() {
 			;)
 }
 
+bool EventGenerator::isForward() {
+	return true; // always keep workload on same rank
+}
+
+/**
+ * Starts the generator threads, then reports the achieved throughput of the
+ * rank every GENERATOR_REPORT_INTERVAL seconds.
+ */
 void EventGenerator::streamProcess(int channel) {
 
 	D(
@@ -84,192 +117,261 @@ void EventGenerator::streamProcess(int channel) {
 			<< rank << " CHANNEL " << channel << endl
 			;)
 
-	Message* message;
-	Message** outMessagesPerSec = new Message*[PER_SEC_MSG_COUNT];
+	start_wtime = MPI_Wtime();
+	start_time = (long int) start_wtime;
 
-	WrapperUnit wrapper_unit;
-	EventDG eventDG;
+	// the threads send the same share of the messages of an iteration
+	int nof_threads = min(GENERATOR_THREADS, PER_SEC_MSG_COUNT);
+	while (PER_SEC_MSG_COUNT % nof_threads != 0)
+		nof_threads--;
 
-	int wrappers_per_msg = 1; // currently only one wrapper per message!
-	int events_per_msg = this->throughput / PER_SEC_MSG_COUNT / worldSize;
+	for (Vertex* v = chainedNext; v != nullptr; v = v->chainedNext)
+		v->chainedThreads = nof_threads;
 
-	long int start_time = (long int) MPI_Wtime();
-	long int t1, t2;
+	vector<GeneratorThread> threads(nof_threads);
 
-	int iteration_count = 0, c = 0;
+	for (int t = 0; t < nof_threads; t++) {
+		threads[t].generator = this;
+		threads[t].id = t;
+		threads[t].nof_threads = nof_threads;
+		pthread_create(&threads[t].thread, NULL,
+				&EventGenerator::startGeneratorThread, (void*) &threads[t]);
+	}
+
+	long int reported_events = 0;
+	double reported_time = start_wtime;
 
 	while (ALIVE) {
 
-//		cout << "\n_________Iteration: " << iteration_count
-//				<< ", Local-throughput: " << (THROUGHPUT / worldSize)
-//				<< ", Start-time: " << (start_time * 1000)
-//				<< ", Per-Sec-Msg-Count: " << PER_SEC_MSG_COUNT << endl;
+		sleep(GENERATOR_REPORT_INTERVAL);
 
-		t1 = MPI_Wtime();
+		long int events = events_generated.load();
+		double time_now = MPI_Wtime();
 
-		int msg_count = 0;
-		while (msg_count < PER_SEC_MSG_COUNT) {
+		stringstream line;
+		line << "GENERATOR AT RANK " << (rank + 1) << "/" << worldSize
+				<< " | REQUESTED: " << (throughput / worldSize)
+				<< " EVENTS/SEC | ACHIEVED: "
+				<< (long int) ((events - reported_events)
+						/ (time_now - reported_time)) << " EVENTS/SEC\n";
+		ResultSink::console().print(line.str());
 
-			outMessagesPerSec[msg_count] = new Message(
-					events_per_msg * sizeof(EventDG), wrappers_per_msg);
+		reported_events = events;
+		reported_time = time_now;
+	}
 
-			// Message header
-			long int time_now = (start_time + iteration_count) * 1000;
-			wrapper_unit.window_start_time = time_now + 999; // this is the max-event-end-time
-			wrapper_unit.completeness_tag_numerator = 1;
-			wrapper_unit.completeness_tag_denominator = PER_SEC_MSG_COUNT
-					* worldSize * AGG_WIND_SPAN / 1000;
-
-			memcpy(outMessagesPerSec[msg_count]->buffer, &wrappers_per_msg,
-					sizeof(int));
-			memcpy(outMessagesPerSec[msg_count]->buffer + sizeof(int),
-					&wrapper_unit, sizeof(WrapperUnit));
-			outMessagesPerSec[msg_count]->size += sizeof(int)
-					+ outMessagesPerSec[msg_count]->wrapper_length
-							* sizeof(WrapperUnit);
+	for (GeneratorThread& thread : threads) {
+		pthread_join(thread.thread, (void **) NULL);
+	}
+}
 
-			// Message body
-			getNextMessage(&eventDG, &wrapper_unit,
-					outMessagesPerSec[msg_count], events_per_msg, time_now);
-
-			// Debug output ---
-			Serialization sede;
-//			WrapperUnit wu;
-//			sede.unwrapFirstWU(message, &wu); //index starts from one
-//			sede.printWrapper(&wu);
-//
-
-			for (int e = 0; e < events_per_msg; e++) {
-				sede.YSBdeserializeDG(outMessagesPerSec[msg_count], &eventDG,
-						sizeof(int)
-								+ (outMessagesPerSec[msg_count]->wrapper_length
-										* sizeof(WrapperUnit))
-								+ (e * sizeof(EventDG)));
-				//sede.YSBprintDG(&eventDG);
-			}
-		D(	cout << "message_size: " << outMessagesPerSec[msg_count]->size
-					<< "\tmessage_capacity: "
-					<< outMessagesPerSec[msg_count]->capacity << endl;)
-			// ----
+void* EventGenerator::startGeneratorThread(void* params) {
+	GeneratorThread* thread = (GeneratorThread*) params;
+	thread->generator->generate(thread->id, thread->nof_threads);
+	return NULL;
+}
 
-			msg_count++;
-			c++;
-		}
+/**
+ * Generator thread: sends the messages thread, thread + nof_threads, ... of
+ * every iteration. The messages of an iteration are released one by one at
+ * regular intervals over MSG_TIME_SPAN, instead of in a burst at the end of
+ * the iteration.
+ */
+void EventGenerator::generate(int thread, int nof_threads) {
 
-		t2 = MPI_Wtime();
-		while ((t2 - t1) < 1) {
-			usleep(100);
-			t2 = MPI_Wtime();
-		}
+	int events_per_msg = this->throughput * MSG_TIME_SPAN / 1000
+			/ PER_SEC_MSG_COUNT / worldSize;
+
+	// independent generator per thread (and rank), never 0
+	uint64_t seed = ((uint64_t) time(NULL) << 20)
+			^ ((uint64_t) rank << 8) ^ (uint64_t) (thread + 1);
+	seed = seed * 0x9E3779B97F4A7C15ULL | 1;
 
-		msg_count = 0;
-		while (msg_count < PER_SEC_MSG_COUNT) {
-			// Replicate data to all subsequent vertices, do not actually reshard the data here
-			int n = 0;
-			for (vector<Vertex*>::iterator v = next.begin(); v != next.end();
-					++v) {
-
-				int idx = n * worldSize + rank; // always keep workload on same rank
-
-				if (PIPELINE) {
-
-					// Pipeline mode: immediately copy message into next operator's queue
-					pthread_mutex_lock(&(*v)->listenerMutexes[idx]);
-					(*v)->inMessages[idx].push_back(
-							outMessagesPerSec[msg_count]);
-
-					D(
-							cout << "EVENTGENERATOR->PIPELINE MESSAGE [" << tag
-							<< "] #" << c << " @ " << rank
-							<< " IN-CHANNEL " << channel
-							<< " OUT-CHANNEL " << idx << " SIZE "
-							<< outMessagesPerSec[msg_count]->size << " CAP "
-							<< outMessagesPerSec[msg_count]->capacity << endl
-							;)
-
-					pthread_cond_signal(&(*v)->listenerCondVars[idx]);
-					pthread_mutex_unlock(&(*v)->listenerMutexes[idx]);
-
-				} else {
-
-					// Normal mode: synchronize on outgoing message channel & send message
-					pthread_mutex_lock(&senderMutexes[idx]);
-					outMessages[idx].push_back(outMessagesPerSec[msg_count]);
-
-					D(
-							cout << "EVENTGENERATOR->PUSHBACK MESSAGE [" << tag
-							<< "] #" << c << " @ " << rank
-							<< " IN-CHANNEL " << channel
-							<< " OUT-CHANNEL " << idx << " SIZE "
-							<< outMessagesPerSec[msg_count]->size << " CAP "
-							<< outMessagesPerSec[msg_count]->capacity << endl
-							;)
-
-					pthread_cond_signal(&senderCondVars[idx]);
-					pthread_mutex_unlock(&senderMutexes[idx]);
-				}
-
-				n++;
-				break; // only one successor node allowed!
+	Message* message;
+	long int iteration_count = 0;
+
+	while (ALIVE) {
+
+		long int time_now = start_time * 1000 + iteration_count * MSG_TIME_SPAN;
+		vector<WrapperUnit> wrapper_units = getWrapperUnits(time_now);
+
+		for (int m = thread; m < PER_SEC_MSG_COUNT; m += nof_threads) {
+
+			// Message header
+			message = new Message(events_per_msg * sizeof(EventDG),
+					wrapper_units.size());
+
+			MessageHeader header;
+			header.nof_wrapper_units = wrapper_units.size();
+			header.timestamp = time_now;
+			MessageHeader::write(header, message);
+			for (size_t u = 0; u < wrapper_units.size(); u++) {
+				MessageHeader::writeWrapperUnit(wrapper_units[u], u, message);
 			}
+			message->size += MessageHeader::length(message->wrapper_length);
 
-			msg_count++;
+			// Message body
+			getNextMessage(message, events_per_msg, time_now, seed);
+
+			D(cout << "message_size: " << message->size
+					<< "\tmessage_capacity: " << message->capacity << endl;)
+
+			// wait for the slot of the message
+			double release_time = start_wtime
+					+ (iteration_count * MSG_TIME_SPAN
+							+ (m + 1) * MSG_TIME_SPAN / (double) PER_SEC_MSG_COUNT)
+							/ 1000.0;
+			while (MPI_Wtime() < release_time) {
+				usleep(100);
+			}
+
+			send(message, thread);
+
+			events_generated += events_per_msg;
 		}
 
 		iteration_count++;
 	}
 }
 
-void EventGenerator::getNextMessage(EventDG* event, WrapperUnit* wrapper_unit,
-		Message* message, int events_per_msg, long int time_now) {
+void EventGenerator::send(Message* message, int thread) {
 
-	Serialization sede;
+	if (chainedNext != nullptr) {
+		// Chained mode: the successor reads the events in place, on this thread
+		// and on the channel of this thread
+		chainedNext->processBatch(RecordBatch::of<EventDG>(message),
+				rank * GENERATOR_THREADS + thread);
+		delete message;
+		return;
+	}
 
-	memcpy(event->ad_id, "3192274f-32f1-442b-8fc0-d5491664a447\0", 37); //default ad_id that would be replaced later
-	memcpy(event->userid_pageid_ipaddress,
-			"7ad5154e-b296-4b07-9cb8-15bb6a395b2f,328df5ff-0e4a-4f8e-b3ea-5c35d6a3fb3b,1.2.3.4\0",
-			82); //default values that would be used for all the events
+	// Replicate data to all subsequent vertices, do not actually reshard the data here
+	int n = 0;
+	for (vector<Vertex*>::iterator v = next.begin(); v != next.end(); ++v) {
+
+		int idx = n * worldSize + rank; // always keep workload on same rank
+
+		if (PIPELINE) {
+
+			// Pipeline mode: immediately copy message into next operator's queue
+			pthread_mutex_lock(&(*v)->listenerMutexes[idx]);
+			(*v)->inMessages[idx].push_back(message);
+
+			D(
+					cout << "EVENTGENERATOR->PIPELINE MESSAGE [" << tag
+					<< "] @ " << rank
+					<< " OUT-CHANNEL " << idx << " SIZE "
+					<< message->size << " CAP "
+					<< message->capacity << endl
+					;)
+
+			pthread_cond_signal(&(*v)->listenerCondVars[idx]);
+			pthread_mutex_unlock(&(*v)->listenerMutexes[idx]);
 
-	long int max_time = 0;
+		} else {
+
+			// Normal mode: synchronize on outgoing message channel & send message
+			pthread_mutex_lock(&senderMutexes[idx]);
+			outMessages[idx].push_back(message);
+
+			D(
+					cout << "EVENTGENERATOR->PUSHBACK MESSAGE [" << tag
+					<< "] @ " << rank
+					<< " OUT-CHANNEL " << idx << " SIZE "
+					<< message->size << " CAP "
+					<< message->capacity << endl
+					;)
+
+			pthread_cond_signal(&senderCondVars[idx]);
+			pthread_mutex_unlock(&senderMutexes[idx]);
+		}
+
+		n++;
+		break; // only one successor node allowed!
+	}
+}
+
+/**
+ * Appends events_per_msg events to the message: each event is a copy of a
+ * random template (uniform over the ad_ids and the event types), stamped
+ * with its event time.
+ */
+void EventGenerator::getNextMessage(Message* message, int events_per_msg,
+		long int time_now, uint64_t& seed) {
+
+	EventDG chunk[GENERATOR_CHUNK];
+	S_CHECK(stringstream lines;)
 
-	// Serializing the events
 	int i = 0;
 	while (i < events_per_msg) {
 
-		memcpy(event->ad_id, ad_ids[myrandom(0, 999)].c_str(), 36);
-		event->event_time = time_now + (999 - i % 1000); // uniformly distribute event times among current message window, upper first
-		//event->event_time = (long int) (MPI_Wtime() * 1000);
+		int nof_events = min(GENERATOR_CHUNK, events_per_msg - i);
 
-		int rand_val = myrandom(0, 2);
+		for (int e = 0; e < nof_events; e++, i++) {
 
-		//memcpy(event->event_type, eventtypes[rand_val].c_str(), strlen(eventtypes[rand_val].c_str()));
-		strcpy(event->event_type, eventtypes[rand_val].c_str());
+			uint64_t index = ((nextRandom(seed) >> 32) * templates.size()) >> 32;
+			chunk[e] = templates[index];
+			chunk[e].event_time = time_now + (MSG_TIME_SPAN - 1 - i % MSG_TIME_SPAN); // uniformly distribute event times among current message window, upper first
 
-		S_CHECK(
-			datafile << event->event_time << "\t"
-					//divide this by the agg wid size
-					<< event->event_time / AGG_WIND_SPAN << "\t"
-					//divide this by the agg wid size
-					<< rank << "\t" << i << "\t" << event->event_type << "\t"
-					<< event->ad_id << endl;
-		);
+			S_CHECK(
+				lines << chunk[e].event_time << "\t"
+						//divide this by the agg wid size
+						<< chunk[e].event_time / AGG_WIND_SPAN << "\t"
+						//divide this by the agg wid size
+						<< rank << "\t" << i << "\t" << chunk[e].event_type << "\t"
+						<< chunk[e].ad_id << endl;
+			);
+		}
 
-		sede.YSBserializeDG(event, message);
+		Codec<EventDG>::encode(chunk, nof_events, message);
+	}
 
-		if (max_time < event->event_time)
-			max_time = event->event_time;
+	S_CHECK(
+		pthread_mutex_lock(&datafile_mutex);
+		datafile << lines.rdbuf();
+		pthread_mutex_unlock(&datafile_mutex);
+	);
+}
 
-		i++;
+/**
+ * Wrapper units of a message covering the event times [time_now, time_now + MSG_TIME_SPAN).
+ *
+ * There is one unit per window overlapped by the message, its completeness is
+ * the overlap in milliseconds. Every rank sends PER_SEC_MSG_COUNT messages
+ * covering the same time span, so a window is complete once the numerators
+ * add up to PER_SEC_MSG_COUNT * worldSize * AGG_WIND_SPAN.
+ */
+vector<WrapperUnit> EventGenerator::getWrapperUnits(long int time_now) {
+
+	vector<WrapperUnit> wrapper_units;
+
+	long int end_time = time_now + MSG_TIME_SPAN; // exclusive
+	long int from = time_now;
+
+	while (from < end_time) {
+		long int to = min((from / AGG_WIND_SPAN + 1) * AGG_WIND_SPAN, end_time);
+
+		WrapperUnit wrapper_unit;
+		wrapper_unit.window_start_time = to - 1; // this is the max-event-end-time in the window
+		wrapper_unit.completeness_tag_numerator = to - from;
+		wrapper_unit.completeness_tag_denominator = PER_SEC_MSG_COUNT
+				* worldSize * AGG_WIND_SPAN;
+		wrapper_units.push_back(wrapper_unit);
+
+		from = to;
+	}
+
+	if ((int) wrapper_units.size() > MAX_WRAPPER_SIZE) {
+		throw "[EventGenerator](getWrapperUnits) A message spans more than MAX_WRAPPER_SIZE windows, decrease MSG_TIME_SPAN";
 	}
 
-	wrapper_unit->window_start_time = max_time;
+	return wrapper_units;
 }
 
-int EventGenerator::myrandom(int min, int max) { //range : [min, max)
-	static bool first = true;
-	if (first) {
-		srand(time(NULL));
-		first = false;
-	}
-	return min + rand() % ((max + 1) - min);
+// xorshift64*, one state per generator thread
+uint64_t EventGenerator::nextRandom(uint64_t& seed) {
+	seed ^= seed >> 12;
+	seed ^= seed << 25;
+	seed ^= seed >> 27;
+	return seed * 2685821657736338717ULL;
 }
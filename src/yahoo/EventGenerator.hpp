@@ -40,6 +40,19 @@
 
 using namespace std;
 #include <fstream>
+#include <atomic>
+#include <cstdint>
+
+// generator threads per rank, each sends its own share of the
+// PER_SEC_MSG_COUNT messages of an iteration. In chained mode, each thread
+// runs the chained successors on its own channel, rank * GENERATOR_THREADS + thread
+static const int GENERATOR_THREADS = 2;
+
+// seconds between two reports of the achieved throughput
+static const int GENERATOR_REPORT_INTERVAL = 10;
+
+// events stamped on the stack before they are copied to a message
+static const int GENERATOR_CHUNK = 64;
 
 class EventGenerator: public Vertex {
 
@@ -53,18 +66,46 @@ public:
 
 	void streamProcess(int channel);
 
+	bool isForward();
+
 private:
 
+	struct GeneratorThread {
+		EventGenerator* generator;
+		int id;
+		int nof_threads;
+		pthread_t thread;
+	};
+
 	unsigned long throughput;
 
 	std::ofstream datafile;
+	pthread_mutex_t datafile_mutex;
 
 	vector<string> ad_ids;
 
-	void getNextMessage(EventDG* event, WrapperUnit* wrapper_unit,
-			Message* message, int events_per_msg, long int time_now);
+	// one pre-built event per (ad_id, event_type), only the event time
+	// is set when an event is generated
+	vector<EventDG> templates;
+
+	// start of the first iteration, in seconds
+	long int start_time;
+	double start_wtime;
+
+	atomic<long int> events_generated;
+
+	static void* startGeneratorThread(void* params);
+
+	void generate(int thread, int nof_threads);
+
+	void getNextMessage(Message* message, int events_per_msg,
+			long int time_now, uint64_t& seed);
+
+	void send(Message* message, int thread);
+
+	vector<WrapperUnit> getWrapperUnits(long int time_now);
 
-	int myrandom(int min, int max);
+	static uint64_t nextRandom(uint64_t& seed);
 
 	string eventtypes[3] = {"click", "view", "purchase"};
 
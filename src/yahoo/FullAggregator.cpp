@@ -41,6 +41,7 @@
 
 #include "../communication/Message.hpp"
 #include "../communication/Window.hpp"
+#include "../dataflow/SinkTree.hpp"
 #include "../serialization/Serialization.hpp"
 
 using namespace std;
@@ -48,11 +49,19 @@ using namespace std;
 FullAggregator::FullAggregator(int tag, int rank, int worldSize) :
 		Vertex(tag, rank, worldSize) {
 	D(cout << "FULLAGGREGATOR [" << tag << "] CREATED @ " << rank << endl;);
-	pthread_mutex_init(&WIDtoIHM_mutex, NULL);
-	pthread_mutex_init(&WIDtoWrapperUnit_mutex, NULL);
+	pthread_mutex_init(&channelTables_mutex, NULL);
+
+	results = ResultSink::open<EventPC>("Data/windows" + to_string(rank) + ".csv");
 }
 
 FullAggregator::~FullAggregator() {
+	delete results;
+
+	for (auto& tables : channelTables) {
+		pthread_mutex_destroy(&tables.second->mutex);
+		delete tables.second;
+	}
+	pthread_mutex_destroy(&channelTables_mutex);
 	D(cout << "FULLAGGREGATOR [" << tag << "] DELETED @ " << rank << endl;);
 }
 
@@ -70,8 +79,8 @@ void FullAggregator::streamProcess(int channel) {
 	Serialization sede;
 
 	WIDtoWrapperUnitHMap::iterator WIDtoWrapperUnit_it;
-	OuterHMap::iterator WIDtoIHM_it;
-	InnerHMap::iterator CIDtoCountAndMaxEventTime_it;
+
+	ChannelTables* tables = getTables(channel);
 
 	WrapperUnit wrapper_unit;
 	EventPA eventPA;
@@ -114,159 +123,101 @@ void FullAggregator::streamProcess(int channel) {
 			list<long int> completed_windows;
 
 			sede.unwrap(inMessage);
-			if (inMessage->wrapper_length > 0) {
-
-				sede.unwrapFirstWU(inMessage, &wrapper_unit);
-//				sede.printWrapper(&wrapper_unit);
-
-				WID = wrapper_unit.window_start_time / AGG_WIND_SPAN;
-
-				if (wrapper_unit.completeness_tag_denominator == 1) {
-					completed_windows.push_back(WID);
-				} else {
-					pthread_mutex_lock(&WIDtoWrapperUnit_mutex); //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-
-					if ((WIDtoWrapperUnit_it = WIDtoWrapperUnit.find(WID))
-							!= WIDtoWrapperUnit.end()) {
-
-						WIDtoWrapperUnit_it->second.first =
-								WIDtoWrapperUnit_it->second.first
-										+ wrapper_unit.completeness_tag_numerator;
 
-						//cout << "____AGGREGATE WRAPPER: " << WID << " NUM="
-						//		<< WIDtoWrapperUnit_it->second.first << " DEN="
-						//		<< WIDtoWrapperUnit_it->second.second << endl;
-
-						if (WIDtoWrapperUnit_it->second.first
-								/ WIDtoWrapperUnit_it->second.second) {
-							completed_windows.push_back(WID);
-							WIDtoWrapperUnit.erase(WID);
-							//cout << "____WID COMPLETE: " << WID << endl;
-						}
-
-					} else {
-
-						WIDtoWrapperUnit.emplace(WID,
-								make_pair(
-										wrapper_unit.completeness_tag_numerator,
-										wrapper_unit.completeness_tag_denominator));
-
-					}
-
-					pthread_mutex_unlock(&WIDtoWrapperUnit_mutex);//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
-				}
-			}
-
-			int offset = sizeof(int)
-					+ (inMessage->wrapper_length * sizeof(WrapperUnit));
+			int offset = MessageHeader::length(inMessage->wrapper_length);
 
 			outMessage = new Message(sizeof(EventPC) * 100); // create new message with max. required capacity
 
-			int event_count = (inMessage->size - offset) / sizeof(EventPA);
+			vector<EventPA> events = Codec<EventPA>::decode(inMessage, offset);
+			int event_count = events.size();
 			//cout << "EVENT_COUNT: " << event_count << endl;
 
-			pthread_mutex_lock(&WIDtoIHM_mutex); //===========================================================================
-
-			int i = 0, j = 0, k = 0;
-			while (i < event_count) {
-
-				sede.YSBdeserializePA(inMessage, &eventPA,
-						offset + (i * sizeof(EventPA)));
+			// the events are aggregated before the wrapper units are counted,
+			// so a window is only complete once all its events are in the tables
+			pthread_mutex_lock(&tables->mutex); //=================================================================
 
-				WID = eventPA.max_event_time / AGG_WIND_SPAN;
+			aggregate(tables->WIDtoTable, events.data(), event_count);
 
-				if ((WIDtoIHM_it = WIDtoIHM.find(WID)) != WIDtoIHM.end()) {
+			pthread_mutex_unlock(&tables->mutex); //===============================================================
 
-					if ((CIDtoCountAndMaxEventTime_it =
-							WIDtoIHM_it->second.find(eventPA.c_id))
-							!= WIDtoIHM_it->second.end()) {
+			if (event_count > 0)
+				eventPA = events[event_count - 1];
 
-						CIDtoCountAndMaxEventTime_it->second.first =
-								CIDtoCountAndMaxEventTime_it->second.first
-										+ eventPA.count;
+			// one wrapper unit per window the message spans
+			for (int u = 0; u < inMessage->wrapper_length; u++) {
 
-						if (CIDtoCountAndMaxEventTime_it->second.second
-								< eventPA.max_event_time) { // new max. event time!
-							CIDtoCountAndMaxEventTime_it->second.second =
-									eventPA.max_event_time;
-						}
+				sede.unwrapWU(inMessage, &wrapper_unit, u);
+//				sede.printWrapper(&wrapper_unit);
 
-					} else { // new entry in inner hashmap!
+				WID = wrapper_unit.window_start_time / AGG_WIND_SPAN;
 
-						WIDtoIHM_it->second.emplace(eventPA.c_id,
-								std::make_pair(eventPA.count,
-										eventPA.max_event_time));
-						k++;
+				if (wrapper_unit.completeness_tag_denominator == 1) {
+					completed_windows.push_back(WID);
+				} else {
+					WIDtoWrapperUnitHMap& units = WIDtoWrapperUnit.lock(WID); //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+					// the first unit may already complete the window (e.g. pre-aggregated upstream)
+					WIDtoWrapperUnit_it = units.emplace(WID,
+							make_pair(0,
+									wrapper_unit.completeness_tag_denominator)).first;
+
+					WIDtoWrapperUnit_it->second.first =
+							WIDtoWrapperUnit_it->second.first
+									+ wrapper_unit.completeness_tag_numerator;
+
+					//cout << "____AGGREGATE WRAPPER: " << WID << " NUM="
+					//		<< WIDtoWrapperUnit_it->second.first << " DEN="
+					//		<< WIDtoWrapperUnit_it->second.second << endl;
+
+					if (WIDtoWrapperUnit_it->second.first
+							/ WIDtoWrapperUnit_it->second.second) {
+						completed_windows.push_back(WID);
+						units.erase(WID);
+						//cout << "____WID COMPLETE: " << WID << endl;
 					}
 
-				} else { // new entry in outer hashmap!
-
-					InnerHMap new_CIDtoCountAndMaxEventTime(100);
-					new_CIDtoCountAndMaxEventTime.emplace(eventPA.c_id,
-							std::make_pair(eventPA.count,
-									eventPA.max_event_time));
-					WIDtoIHM.emplace(WID, new_CIDtoCountAndMaxEventTime);
-
-					j++;
+					WIDtoWrapperUnit.unlock(WID); //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
 				}
-
-				i++;
 			}
 
 			long int time_now = (long int) (MPI_Wtime() * 1000.0);
 			//cout << "\nFULLAGGR TIME_NOW:  " << time_now << endl;
 			//printf("FULLAGGR MPI_Wtime: %lf\n", (MPI_Wtime() * 1000.0));
 
+			CampaignTable table;
+
 			while (!completed_windows.empty()) {
 
 				WID = completed_windows.front();
 				completed_windows.pop_front();
 
-				WIDtoIHM_it = WIDtoIHM.find(WID);
-				if (WIDtoIHM_it != WIDtoIHM.end()) {
-
-					j = 0;
-					for (CIDtoCountAndMaxEventTime_it =
-							WIDtoIHM_it->second.begin();
-							CIDtoCountAndMaxEventTime_it
-									!= WIDtoIHM_it->second.end();
-							CIDtoCountAndMaxEventTime_it++) {
-
-						eventPC.WID = WID;
-						eventPC.c_id = CIDtoCountAndMaxEventTime_it->first;
-						eventPC.count =
-								CIDtoCountAndMaxEventTime_it->second.first;
-						eventPC.latency = (time_now - eventPA.max_event_time);
-
-						cout << "  " << j << "\tWID: " << eventPC.WID
-								<< "\tc_id: " << eventPC.c_id << "\tcount: "
-								<< eventPC.count << "\tlatency: "
-								<< eventPC.latency << " SIZE "
-								<< outMessage->size << " CAP "
-								<< outMessage->capacity << endl;
-
-						sede.YSBserializePC(&eventPC, outMessage);
-						//sede.YSBdeserializePC(outMessage, &eventPC,
-						//		outMessage->size - sizeof(EventPC));
-						//sede.YSBprintPC(&eventPC);
-						j++;
-					}
+				merge(WID, table);
 
-					WIDtoIHM_it->second.clear(); // clear inner map
-					WIDtoIHM.erase(WID); // remove from outer map
-				}
+				table.forEach(
+						[&](long int c_id, int count, long int) {
+
+							eventPC.WID = WID;
+							eventPC.c_id = c_id;
+							eventPC.count = count;
+							eventPC.latency = (time_now - eventPA.max_event_time);
+
+							sede.YSBserializePC(&eventPC, outMessage);
+						});
+
+				table.clear(); // keeps the table for a next window
 			}
 
-			pthread_mutex_unlock(&WIDtoIHM_mutex); //====================================================================
+			// every result of the window, written by the writer thread of the sink
+			results->write(Codec<EventPC>::decode(outMessage, 0));
 
-			// Finally send message to a single collector on rank 0
+			// Finally send message to the collector of the results (see SinkTree)
 			int n = 0;
 			for (vector<Vertex*>::iterator v = next.begin(); v != next.end();
 					++v) {
 
 				if (outMessage->size > 0) {
 
-					int idx = n * worldSize + 0; // send to rank 0 only
+					int idx = n * worldSize + SinkTree::resultRank(rank);
 
 					// Normal mode: synchronize on outgoing message channel & send message
 					pthread_mutex_lock(&senderMutexes[idx]);
@@ -299,3 +250,42 @@ void FullAggregator::streamProcess(int channel) {
 
 	delete tmpMessages;
 }
+
+/**
+ * Tables of the channel, only used by its thread (and by merge).
+ */
+ChannelTables* FullAggregator::getTables(int channel) {
+	pthread_mutex_lock(&channelTables_mutex);
+	ChannelTables*& tables = channelTables[channel];
+	if (tables == nullptr) {
+		tables = new ChannelTables();
+		pthread_mutex_init(&tables->mutex, NULL);
+	}
+	pthread_mutex_unlock(&channelTables_mutex);
+	return tables;
+}
+
+/**
+ * Moves the counts of the completed window from the tables of every channel
+ * to the merged table.
+ */
+void FullAggregator::merge(long int WID, CampaignTable& merged) {
+
+	pthread_mutex_lock(&channelTables_mutex);
+
+	for (auto& channel : channelTables) {
+		ChannelTables* tables = channel.second;
+
+		pthread_mutex_lock(&tables->mutex);
+
+		CampaignTable* table = tables->WIDtoTable.find(WID);
+		if (table != nullptr) {
+			merged.merge(*table);
+			tables->WIDtoTable.erase(WID);
+		}
+
+		pthread_mutex_unlock(&tables->mutex);
+	}
+
+	pthread_mutex_unlock(&channelTables_mutex);
+}
@@ -38,23 +38,32 @@
 #include <utility>
 
 #include "../dataflow/Vertex.hpp"
+#include "../dataflow/LockStripes.hpp"
+#include "AggregationTable.hpp"
+#include "../output/ResultSink.hpp"
 
 using namespace std;
 
-typedef std::pair<int, long int> count_maxeventtime;
-typedef unordered_map<long int, count_maxeventtime> InnerHMap;
-typedef unordered_map<long int, unordered_map<long int, count_maxeventtime>> OuterHMap;
 typedef unordered_map<long int, std::pair<int, int>> WIDtoWrapperUnitHMap;
 
+// campaign counts of the windows received on one channel
+typedef struct ChannelTables {
+	WindowTable<CampaignTable> WIDtoTable; // Window_ID to campaign counts
+	pthread_mutex_t mutex; // only contended when a window completes
+} ChannelTables;
+
 class FullAggregator: public Vertex {
 
 public:
 
-	OuterHMap WIDtoIHM;
-	pthread_mutex_t WIDtoIHM_mutex;
+	// every channel aggregates into its own tables, which are merged when
+	// the window completes
+	unordered_map<int, ChannelTables*> channelTables;
+	pthread_mutex_t channelTables_mutex;
+
+	LockStripes<WIDtoWrapperUnitHMap> WIDtoWrapperUnit; // striped by Window_ID
 
-	WIDtoWrapperUnitHMap WIDtoWrapperUnit;
-	pthread_mutex_t WIDtoWrapperUnit_mutex;
+	ResultSink* results; // every (window, campaign) count, out of the processing threads
 
 	FullAggregator(int tag, int rank, int worldSize);
 
@@ -64,6 +73,12 @@ public:
 
 	void streamProcess(int channel);
 
+private:
+
+	ChannelTables* getTables(int channel);
+
+	void merge(long int WID, CampaignTable& merged);
+
 };
 
 #endif /* OPERATOR_FULLAGGREGATOR_HPP_ */
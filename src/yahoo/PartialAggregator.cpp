@@ -41,6 +41,8 @@
 #include <string>
 #include <sstream>
 #include <unordered_map>
+#include <mpi.h>
+#include <sys/time.h>
 
 #include "../communication/Message.hpp"
 #include "../function/Function.hpp"
@@ -48,12 +50,16 @@
 
 using namespace std;
 
-PartialAggregator::PartialAggregator(int tag, int rank, int worldSize) :
+PartialAggregator::PartialAggregator(int tag, int rank, int worldSize,
+		long flush_interval) :
 		Vertex(tag, rank, worldSize) {
+	this->flush_interval = flush_interval;
+	pthread_mutex_init(&windows_mutex, NULL);
 	D(cout << "PARTIALAGGREGATOR [" << tag << "] CREATED @ " << rank << endl;);
 }
 
 PartialAggregator::~PartialAggregator() {
+	pthread_mutex_destroy(&windows_mutex);
 	D(cout << "PARTIALAGGREGATOR [" << tag << "] DELETED @ " << rank << endl;);
 }
 
@@ -62,32 +68,55 @@ void PartialAggregator::batchProcess() {
 			<< endl;);
 }
 
+bool PartialAggregator::isChainable() {
+	return true;
+}
+
+/**
+ * The partial aggregates of a window are kept across the input messages of
+ * the channel, and only sent to the full aggregator of the window when the
+ * window is flushed (see flush). This way the full aggregator receives one
+ * EventPA per campaign and flush instead of one per campaign and message.
+ */
 void PartialAggregator::streamProcess(int channel) {
 
 	D(cout << "PARTIALAGGREGATOR->STREAMPROCESS [" << tag << "] @ " << rank
 			<< " IN-CHANNEL " << channel << endl;);
 
 	Message* inMessage;
-	Message** outMessagesToWindowIDs = new Message*[worldSize];
 	list<Message*>* tmpMessages = new list<Message*>();
 	Serialization sede;
 
-	OuterHMap WIDtoIHM(10); //Window_ID to Inner-HashMap (IHM) mapping
-	OuterHMap::iterator WIDtoIHM_it;
-	InnerHMap::iterator CIDtoCountAndMaxEventTime_it; //IHM: Campaign_ID to Max-Event-time mapping
-
-	//WrapperUnit wrapper_unit;
-	EventJ eventJ;
-	EventPA eventPA;
+	WIDtoPartialWindowTable& windows = getWindows(channel);
 
 	int c = 0;
 	while (ALIVE) {
 
 		pthread_mutex_lock(&listenerMutexes[channel]);
 
-		while (inMessages[channel].empty())
-			pthread_cond_wait(&listenerCondVars[channel],
-					&listenerMutexes[channel]);
+		// wake up for the next flush if some windows are waiting for one
+		while (inMessages[channel].empty()) {
+
+			double next_flush = getNextFlush(windows);
+
+			if (next_flush == 0) {
+				pthread_cond_wait(&listenerCondVars[channel],
+						&listenerMutexes[channel]);
+			} else {
+				long int remaining = (next_flush - MPI_Wtime()) * 1000000; // USEC
+				if (remaining <= 0)
+					break;
+
+				struct timeval now;
+				struct timespec timeout;
+				gettimeofday(&now, NULL);
+				long int usec = now.tv_usec + remaining;
+				timeout.tv_sec = now.tv_sec + usec / 1000000;
+				timeout.tv_nsec = (usec % 1000000) * 1000;
+				pthread_cond_timedwait(&listenerCondVars[channel],
+						&listenerMutexes[channel], &timeout);
+			}
+		}
 
 //		if(inMessages[channel].size()>1)
 //				  cout<<tag<<" CHANNEL-"<<channel<<" BUFFER SIZE:"<<inMessages[channel].size()<<endl;
@@ -110,151 +139,227 @@ void PartialAggregator::streamProcess(int channel) {
 					<< rank << " CHANNEL " << channel << " BUFFER "
 					<< inMessage->size << endl;);
 
-			long int WID, c_id;
-
 			sede.unwrap(inMessage);
-			//if (inMessage->wrapper_length > 0) {
-			//	sede.unwrapFirstWU(inMessage, &wrapper_unit);
-			//	sede.printWrapper(&wrapper_unit);
-			//}
-
-			int offset = sizeof(int)
-					+ (inMessage->wrapper_length * sizeof(WrapperUnit));
-
-			// Caution: copying the header from the inMessage only works if there is only one wrapper and one window per message!
-			for (int w = 0; w < worldSize; w++) {
-				outMessagesToWindowIDs[w] = new Message(
-						inMessage->size - offset, inMessage->wrapper_length); // create new message with max. required capacity
-				memcpy(outMessagesToWindowIDs[w]->buffer, inMessage->buffer,
-						offset); // simply copy header from old message for now!
-				outMessagesToWindowIDs[w]->size += offset;
-			}
+			aggregate(RecordBatch::of<EventJ>(inMessage), windows);
 
-			int event_count = (inMessage->size - offset) / sizeof(EventFT);
-			D(cout << "\n#EVENT_COUNT: " << event_count <<" TAG: "<<tag<<" RANK: "<<rank<< endl);
+			delete inMessage;
+			c++;
+		}
 
-			int i = 0, j = 0, k = 0;
+		tmpMessages->clear();
 
-			while (i < event_count) {
+		flush(windows, MPI_Wtime(), channel);
+	}
 
-				sede.YSBdeserializeJ(inMessage, &eventJ,
-						offset + (i * sizeof(EventJ)));
+	delete tmpMessages;
+}
 
-				//cout << "  " << i << "\tevent_time: " << eventJ.event_time
-				//		<< "\tc_id: " << eventJ.c_id << endl;
+/**
+ * Chained mode: the batch is aggregated by the thread of the predecessor.
+ * Expired windows are then only flushed when the next batch arrives, which
+ * the generator guarantees every MSG_TIME_SPAN.
+ */
+void PartialAggregator::processBatch(const RecordBatch& batch, int channel) {
 
-				c_id = std::stol(eventJ.c_id, nullptr, 16);
-				WID = (eventJ.event_time / AGG_WIND_SPAN);
+	WIDtoPartialWindowTable& windows = getWindows(channel);
 
-				if ((WIDtoIHM_it = WIDtoIHM.find(WID)) != WIDtoIHM.end()) {
+	aggregate(batch, windows);
 
-					if ((CIDtoCountAndMaxEventTime_it =
-							WIDtoIHM_it->second.find(c_id))
-							!= (WIDtoIHM_it->second).end()) {
+	flush(windows, MPI_Wtime(), channel);
+}
 
-						CIDtoCountAndMaxEventTime_it->second.first =
-								CIDtoCountAndMaxEventTime_it->second.first + 1;
+/**
+ * Adds the events of the batch and the wrapper units of its message to the
+ * partial state of their windows.
+ */
+void PartialAggregator::aggregate(const RecordBatch& batch,
+		WIDtoPartialWindowTable& windows) {
 
-						if (CIDtoCountAndMaxEventTime_it->second.second
-								< eventJ.event_time) { // new max. event time!
-							CIDtoCountAndMaxEventTime_it->second.second =
-									eventJ.event_time;
-						}
+	const Message* message = batch.origin;
+	WrapperUnit wrapper_unit;
 
-					} else { // new entry in inner hashmap!
-						WIDtoIHM_it->second.emplace(c_id,
-								std::make_pair(1, eventJ.event_time));
-						k++;
-					}
+	long int WID, c_id;
+	double now = MPI_Wtime();
 
-				} else { // new entry in the outer hashmap!
-					InnerHMap new_CIDtoCountAndMaxEventTime(100);
-					new_CIDtoCountAndMaxEventTime.emplace(c_id,
-							std::make_pair(1, eventJ.event_time));
-					WIDtoIHM.emplace(WID, new_CIDtoCountAndMaxEventTime);
+	long int timestamp = MessageHeader::peek(message).timestamp;
 
-					j++;
-				}
+	// completeness is only forwarded with the window, summed over the messages
+	for (int u = 0; u < message->wrapper_length; u++) {
+		wrapper_unit = MessageHeader::readWrapperUnit(message, u);
 
-				i++;
-			}
+		WID = wrapper_unit.window_start_time / AGG_WIND_SPAN;
+		PartialWindow& window = windows.get(WID);
 
-			//cout << "EVENTS: " << i << ", OUTER MAP ENTRIES: " << j
-			//		<< ", INNER MAP ENTRIES: " << k << endl;
+		if (window.opened == 0)
+			window.opened = now;
 
-			for (WIDtoIHM_it = WIDtoIHM.begin(); WIDtoIHM_it != WIDtoIHM.end();
-					WIDtoIHM_it++) {
-				int counter = 0, map_size_cal = 0; // for debugging!
+		window.completeness_tag_numerator +=
+				wrapper_unit.completeness_tag_numerator;
+		window.received_numerator += wrapper_unit.completeness_tag_numerator;
+		window.completeness_tag_denominator =
+				wrapper_unit.completeness_tag_denominator;
+		window.timestamp = max(window.timestamp, timestamp);
+	}
 
-				WID = WIDtoIHM_it->first;
+	const EventJ* events = batch.as<EventJ>();
+	int event_count = batch.count;
+	D(cout << "\n#EVENT_COUNT: " << event_count <<" TAG: "<<tag<<" RANK: "<<rank<< endl);
 
-				for (CIDtoCountAndMaxEventTime_it =
-						(WIDtoIHM_it->second).begin();
-						CIDtoCountAndMaxEventTime_it
-								!= (WIDtoIHM_it->second).end();
-						CIDtoCountAndMaxEventTime_it++) {
-					map_size_cal++;
-					eventPA.max_event_time =
-							CIDtoCountAndMaxEventTime_it->second.second;
-					eventPA.count = CIDtoCountAndMaxEventTime_it->second.first;
-					eventPA.c_id = CIDtoCountAndMaxEventTime_it->first;
+	// consecutive events usually belong to the same window
+	long int last_WID = LONG_MIN;
+	PartialWindow* window = nullptr;
 
-					counter = counter + eventPA.count;
+	for (int i = 0; i < event_count; i++) {
 
-					sede.YSBserializePA(&eventPA,
-							outMessagesToWindowIDs[WID % worldSize]);
+		const EventJ& eventJ = events[i];
 
-				}
+		//cout << "  " << i << "\tevent_time: " << eventJ.event_time
+		//		<< "\tc_id: " << eventJ.c_id << endl;
 
-				D(cout << " #W_ID: " << eventPA.max_event_time/AGG_WIND_SPAN
-						<< " #Event_time: " << eventPA.max_event_time
-						<<"\t map size: " << WIDtoIHM_it->second.size()
-						<<"\t map_size_cal: "<<map_size_cal
-						<< endl;);
+		c_id = std::stol(eventJ.c_id, nullptr, 16);
+		WID = (eventJ.event_time / AGG_WIND_SPAN);
 
-				WIDtoIHM_it->second.clear();
+		if (WID != last_WID) {
+			window = &windows.get(WID);
+			last_WID = WID;
+		}
 
-			}
-			WIDtoIHM.clear();
+		if (window->opened == 0)
+			window->opened = now;
 
-			int n = 0;
-			for (vector<Vertex*>::iterator v = next.begin(); v != next.end();
-					++v) {
+		window->CIDtoCountAndMaxEventTime.add(c_id, 1, eventJ.event_time);
+	}
+}
 
-				for (int w = 0; w < worldSize; w++) {
+/**
+ * A window is flushed once this channel received its share of the window
+ * (every rank generates the same share, as in the YSB generator, split
+ * between the chainedThreads channels of the rank in chained mode), or
+ * when it has been waiting for flush_interval.
+ *
+ * The flushed message carries the events of the window and a single
+ * wrapper unit with the completeness received since the previous flush,
+ * so the full aggregator still sums up to the exact completeness of the
+ * window, however many times it is flushed.
+ */
+void PartialAggregator::flush(WIDtoPartialWindowTable& windows, double now,
+		int channel) {
 
-					int idx = n * worldSize + w; // iterate over all ranks
+	Serialization sede;
+	EventPA eventPA;
+	WrapperUnit wrapper_unit;
 
-					if (outMessagesToWindowIDs[w]->size > 20) { // quick fix for now
+	windows.forEach([&](long int WID, PartialWindow& window) {
 
-						// Normal mode: synchronize on outgoing message channel & send message
-						pthread_mutex_lock(&senderMutexes[idx]);
-						outMessages[idx].push_back(outMessagesToWindowIDs[w]);
+		bool pending = window.opened != 0;
+		bool complete = window.completeness_tag_denominator > 0
+				&& (long int) window.received_numerator * worldSize
+						* chainedThreads >= window.completeness_tag_denominator;
+		bool expired = pending
+				&& (now - window.opened) * 1000 >= flush_interval;
 
-						D(cout << "PARTIALAGGREGATOR->PUSHBACK MESSAGE [" << tag
-								<< "] #" << c << " @ " << rank << " IN-CHANNEL "
-								<< channel << " OUT-CHANNEL " << idx << " SIZE "
-								<< outMessagesToWindowIDs[w]->size << " CAP "
-								<< outMessagesToWindowIDs[w]->capacity << endl);
+		if (!pending || (!complete && !expired)) {
+			return;
+		}
 
-						pthread_cond_signal(&senderCondVars[idx]);
-						pthread_mutex_unlock(&senderMutexes[idx]);
+		Message* outMessage = new Message(
+				window.CIDtoCountAndMaxEventTime.size() * sizeof(EventPA), 1);
 
-					} else {
+		MessageHeader header;
+		header.timestamp = window.timestamp;
 
-						delete outMessagesToWindowIDs[w];
-					}
-				}
+		// events without wrapper units (in the current message) don't make
+		// the window any more complete, only forward their aggregates
+		if (window.completeness_tag_denominator > 0) {
+			header.nof_wrapper_units = 1;
 
-				n++;
-			}
+			wrapper_unit.window_start_time = WID * AGG_WIND_SPAN;
+			wrapper_unit.completeness_tag_numerator =
+					window.completeness_tag_numerator;
+			wrapper_unit.completeness_tag_denominator =
+					window.completeness_tag_denominator;
+			MessageHeader::writeWrapperUnit(wrapper_unit, 0, outMessage);
+		}
 
-			delete inMessage;
-			c++;
+		MessageHeader::write(header, outMessage);
+		outMessage->size += MessageHeader::length(header.nof_wrapper_units);
+
+		window.CIDtoCountAndMaxEventTime.forEach(
+				[&](long int c_id, int count, long int max_event_time) {
+					eventPA.max_event_time = max_event_time;
+					eventPA.count = count;
+					eventPA.c_id = c_id;
+
+					sede.YSBserializePA(&eventPA, outMessage);
+				});
+
+		D(cout << " #W_ID: " << WID << "\t map size: "
+				<< window.CIDtoCountAndMaxEventTime.size()
+				<< "\t numerator: " << window.completeness_tag_numerator
+				<< endl;);
+
+		// the wrapper unit has to reach the owner of the window even when
+		// there is no event, or the window would never complete there
+		int w = WID % worldSize;
+
+		int n = 0;
+		for (vector<Vertex*>::iterator v = next.begin(); v != next.end();
+				++v) {
+
+			int idx = n * worldSize + w; // owner of the window
+
+			// Normal mode: synchronize on outgoing message channel & send message
+			pthread_mutex_lock(&senderMutexes[idx]);
+			outMessages[idx].push_back(outMessage);
+
+			D(cout << "PARTIALAGGREGATOR->PUSHBACK MESSAGE [" << tag
+					<< "] @ " << rank << " IN-CHANNEL "
+					<< channel << " OUT-CHANNEL " << idx << " SIZE "
+					<< outMessage->size << " CAP "
+					<< outMessage->capacity << endl);
+
+			pthread_cond_signal(&senderCondVars[idx]);
+			pthread_mutex_unlock(&senderMutexes[idx]);
+
+			n++;
+			break; // only one successor node allowed!
 		}
 
-		tmpMessages->clear();
-	}
+		// keep counting the completeness of the window until its share is received
+		if (complete) {
+			windows.erase(WID);
+		} else {
+			window.CIDtoCountAndMaxEventTime.clear();
+			window.completeness_tag_numerator = 0;
+			window.opened = 0;
+		}
+	});
+}
 
-	delete tmpMessages;
+/**
+ * Returns the MPI_Wtime at which the next window has to be flushed,
+ * or 0 if no window is waiting for a flush.
+ */
+double PartialAggregator::getNextFlush(const WIDtoPartialWindowTable& windows) {
+	double next_flush = 0;
+	windows.forEach([&](long int, const PartialWindow& window) {
+		if (window.opened == 0)
+			return;
+
+		double flush = window.opened + flush_interval / 1000.0;
+		if (next_flush == 0 || flush < next_flush)
+			next_flush = flush;
+	});
+	return next_flush;
+}
+
+/**
+ * Partial state of the channel. The channels are processed by different
+ * threads, or by the generator threads in chained mode (one channel each).
+ */
+WIDtoPartialWindowTable& PartialAggregator::getWindows(int channel) {
+	pthread_mutex_lock(&windows_mutex);
+	WIDtoPartialWindowTable& windows = channelWindows[channel]; // references stay valid on insertion
+	pthread_mutex_unlock(&windows_mutex);
+	return windows;
 }
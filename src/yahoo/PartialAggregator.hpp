@@ -38,18 +38,40 @@
 #include <utility>
 
 #include "../dataflow/Vertex.hpp"
+#include "AggregationTable.hpp"
 
 using namespace std;
 
-typedef std::pair<int, long int> count_maxeventtime;
-typedef unordered_map<long int, count_maxeventtime> InnerHMap;
-typedef unordered_map<long int, unordered_map<long int, count_maxeventtime>> OuterHMap;
+// a window is flushed at the latest this long after its first event (or wrapper unit)
+static const long PARTIAL_AGG_FLUSH_INTERVAL = 1000; //MSEC
+
+// partial aggregates of a window, kept across input messages until the window is flushed
+typedef struct PartialWindow {
+	CampaignTable CIDtoCountAndMaxEventTime;
+	int completeness_tag_numerator = 0; // sum of the wrapper units received since the last flush
+	int completeness_tag_denominator = 0;
+	int received_numerator = 0; // sum of all the wrapper units received by the channel
+	long int timestamp = 0; // latest message timestamp
+	double opened = 0; // MPI_Wtime of the first update since the last flush, 0 if nothing to flush
+
+	void clear() {
+		CIDtoCountAndMaxEventTime.clear();
+		completeness_tag_numerator = 0;
+		completeness_tag_denominator = 0;
+		received_numerator = 0;
+		timestamp = 0;
+		opened = 0;
+	}
+} PartialWindow;
+
+typedef WindowTable<PartialWindow> WIDtoPartialWindowTable;
 
 class PartialAggregator: public Vertex {
 
 public:
 
-	PartialAggregator(int tag, int rank, int worldSize);
+	PartialAggregator(int tag, int rank, int worldSize, long flush_interval =
+			PARTIAL_AGG_FLUSH_INTERVAL);
 
 	~PartialAggregator();
 
@@ -57,6 +79,25 @@ public:
 
 	void streamProcess(int channel);
 
+	bool isChainable();
+
+	void processBatch(const RecordBatch& batch, int channel);
+
+private:
+
+	long flush_interval; // MSEC
+
+	unordered_map<int, WIDtoPartialWindowTable> channelWindows; // channel to Window_ID to partial state
+	pthread_mutex_t windows_mutex;
+
+	WIDtoPartialWindowTable& getWindows(int channel);
+
+	void aggregate(const RecordBatch& batch, WIDtoPartialWindowTable& windows);
+
+	void flush(WIDtoPartialWindowTable& windows, double now, int channel);
+
+	double getNextFlush(const WIDtoPartialWindowTable& windows);
+
 };
 
 #endif /* OPERATOR_PARTIALAGGREGATOR_HPP_ */
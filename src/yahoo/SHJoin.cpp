@@ -81,21 +81,23 @@ void SHJoin::batchProcess() {
 	D(cout << "SHJOIN->BATCHPROCESS [" << tag << "] @ " << rank << endl;)
 }
 
+bool SHJoin::isChainable() {
+	return true;
+}
+
+bool SHJoin::isForward() {
+	return true; // always keep workload on same rank
+}
+
 void SHJoin::streamProcess(int channel) {
 
 	D(cout << "SHJOIN->STREAMPROCESS [" << tag << "] @ " << rank << " IN-CHANNEL "
 			<< channel << endl;)
 
-	Message* inMessage, *outMessage;
+	Message* inMessage;
 	list<Message*>* tmpMessages = new list<Message*>();
 	Serialization sede;
 
-	adToCampaignHMap::iterator it;
-
-	//WrapperUnit wrapper_unit;
-	EventFT eventFT;
-	EventJ eventJ;
-
 	int c = 0;
 
 	while (ALIVE) {
@@ -133,95 +135,117 @@ void SHJoin::streamProcess(int channel) {
 			//	sede.printWrapper(&wrapper_unit);
 			//}
 
-			int offset = sizeof(int)
-					+ (inMessage->wrapper_length * sizeof(WrapperUnit));
+			// the events are read in place from the message
+			processBatch(RecordBatch::of<EventFT>(inMessage), channel);
+
+			delete inMessage;
+			c++;
+		}
+
+		tmpMessages->clear();
+	}
+
+	delete tmpMessages;
+}
+
+/**
+ * Joins the events of the batch with the ad-to-campaign mapping, then hands
+ * the joined events over to the chained successor, or sends them in a
+ * message with the same header.
+ */
+void SHJoin::processBatch(const RecordBatch& batch, int channel) {
 
-			outMessage = new Message(inMessage->size - offset,
-					inMessage->wrapper_length); // create new message with max. required capacity
-			memcpy(outMessage->buffer, inMessage->buffer, offset); // simply copy header from old message for now!
-			outMessage->size += offset;
+	const EventFT* events = batch.as<EventFT>();
+	int event_count = batch.count;
 
-			int event_count = (inMessage->size - offset) / sizeof(EventFT);
+	D(cout << "EVENT_COUNT: " << event_count << endl;)
 
-			D(cout << "EVENT_COUNT: " << event_count << endl;)
+	adToCampaignHMap::iterator it;
 
-			int i = 0, j = 0;
-			while (i < event_count) {
+	vector<EventJ> joined;
+	joined.reserve(event_count);
 
-				sede.YSBdeserializeFT(inMessage, &eventFT,
-						offset + (i * sizeof(EventFT)));
+	EventJ eventJ;
 
-				if ((it = map.find(eventFT.ad_id)) != map.end()) {
+	int i = 0;
+	while (i < event_count) {
 
-					//cout << "  " << i << "\tevent_time: " << eventFT.event_time
-					//		<< "\tad_id: " << eventFT.ad_id << "\tc_id: "
-					//		<< it->second << endl;
+		const EventFT& eventFT = events[i];
 
-					eventJ.event_time = eventFT.event_time;
-					memcpy(eventJ.c_id, it->second.c_str(), 37);
-					sede.YSBserializeJ(&eventJ, outMessage); // store joined events directly in outgoing message!
-					//sede.YSBdeserializeJ(outMessage, &eventJ,
-					//		outMessage->size - sizeof(EventJ));
-					//sede.YSBprintJ(&eventJ);
-					j++;
-				}
+		if ((it = map.find(eventFT.ad_id)) != map.end()) {
 
-				i++;
-			}
+			//cout << "  " << i << "\tevent_time: " << eventFT.event_time
+			//		<< "\tad_id: " << eventFT.ad_id << "\tc_id: "
+			//		<< it->second << endl;
 
-			D(cout << "W_ID: " << eventFT.event_time /AGG_WIND_SPAN
-					<<" RANK: "<<rank<<" TAG: "<<tag
-					<< "\n-----"<< endl;)
+			eventJ.event_time = eventFT.event_time;
+			memcpy(eventJ.c_id, it->second.c_str(), 37);
+			joined.push_back(eventJ);
+		}
 
-			// Replicate data to all subsequent vertices, do not actually reshard the data here
-			int n = 0, listenerBuffer_offset = 0;
-			for (vector<Vertex*>::iterator v = next.begin(); v != next.end();
-					++v) {
+		i++;
+	}
 
-				int idx = n * worldSize + rank; // always keep workload on same rank
+	D(if (event_count > 0) cout << "W_ID: " << events[event_count - 1].event_time /AGG_WIND_SPAN
+			<<" RANK: "<<rank<<" TAG: "<<tag
+			<< "\n-----"<< endl;)
 
-				if (PIPELINE) {
-					idx = rank; // calculating the index of the buffer at the listener thread
-					// Pipeline mode: immediately copy message into next operator's queue
-					pthread_mutex_lock(&(*v)->listenerMutexes[idx]);
-					(*v)->inMessages[idx].push_back(outMessage);
+	if (chainedNext != nullptr) {
+		// Chained mode: the successor runs on this thread, no message needed
+		chainedNext->processBatch(
+				RecordBatch(batch.origin, joined.data(), joined.size()),
+				channel);
+		return;
+	}
 
-					D(cout << "SHJOIN->PIPELINE MESSAGE [" << tag << "] #" << c
-							<< " @ " << rank << " IN-CHANNEL " << channel
-							<< " OUT-CHANNEL " << idx << " SIZE "
-							<< outMessage->size << " CAP "
-							<< outMessage->capacity << endl;)
+	int offset = MessageHeader::length(batch.origin->wrapper_length);
 
-					pthread_cond_signal(&(*v)->listenerCondVars[idx]);
-					pthread_mutex_unlock(&(*v)->listenerMutexes[idx]);
+	Message* outMessage = new Message(joined.size() * sizeof(EventJ),
+			batch.origin->wrapper_length);
+	memcpy(outMessage->buffer, batch.origin->buffer, offset); // simply copy header from old message for now!
+	outMessage->size += offset;
 
-				} else {
+	Codec<EventJ>::encode(joined, outMessage); // store joined events directly in outgoing message!
 
-					// Normal mode: synchronize on outgoing message channel & send message
-					pthread_mutex_lock(&senderMutexes[idx]);
-					outMessages[idx].push_back(outMessage);
+	// Replicate data to all subsequent vertices, do not actually reshard the data here
+	int n = 0;
+	for (vector<Vertex*>::iterator v = next.begin(); v != next.end();
+			++v) {
 
-					D(cout << "SHJOIN->PUSHBACK MESSAGE [" << tag << "] #" << c
-							<< " @ " << rank << " IN-CHANNEL " << channel
-							<< " OUT-CHANNEL " << idx << " SIZE "
-							<< outMessage->size << " CAP "
-							<< outMessage->capacity << endl;)
+		int idx = n * worldSize + rank; // always keep workload on same rank
 
-					pthread_cond_signal(&senderCondVars[idx]);
-					pthread_mutex_unlock(&senderMutexes[idx]);
-				}
+		if (PIPELINE) {
+			idx = rank; // calculating the index of the buffer at the listener thread
+			// Pipeline mode: immediately copy message into next operator's queue
+			pthread_mutex_lock(&(*v)->listenerMutexes[idx]);
+			(*v)->inMessages[idx].push_back(outMessage);
 
-				n++;
-				break; // only one successor node allowed!
-			}
+			D(cout << "SHJOIN->PIPELINE MESSAGE [" << tag << "] @ " << rank
+					<< " IN-CHANNEL " << channel
+					<< " OUT-CHANNEL " << idx << " SIZE "
+					<< outMessage->size << " CAP "
+					<< outMessage->capacity << endl;)
 
-			delete inMessage;
-			c++;
+			pthread_cond_signal(&(*v)->listenerCondVars[idx]);
+			pthread_mutex_unlock(&(*v)->listenerMutexes[idx]);
+
+		} else {
+
+			// Normal mode: synchronize on outgoing message channel & send message
+			pthread_mutex_lock(&senderMutexes[idx]);
+			outMessages[idx].push_back(outMessage);
+
+			D(cout << "SHJOIN->PUSHBACK MESSAGE [" << tag << "] @ " << rank
+					<< " IN-CHANNEL " << channel
+					<< " OUT-CHANNEL " << idx << " SIZE "
+					<< outMessage->size << " CAP "
+					<< outMessage->capacity << endl;)
+
+			pthread_cond_signal(&senderCondVars[idx]);
+			pthread_mutex_unlock(&senderMutexes[idx]);
 		}
 
-		tmpMessages->clear();
+		n++;
+		break; // only one successor node allowed!
 	}
-
-	delete tmpMessages;
 }
-
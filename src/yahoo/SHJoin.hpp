@@ -54,6 +54,12 @@ public:
 
 	void streamProcess(int channel);
 
+	bool isChainable();
+
+	bool isForward();
+
+	void processBatch(const RecordBatch& batch, int channel);
+
 private:
 
 	adToCampaignHMap map;
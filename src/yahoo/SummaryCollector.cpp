@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) 2020 University of Luxembourg. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF LUXEMBOURG AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE UNIVERSITY OF LUXEMBOURG OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+/*
+ * SummaryCollector.cpp
+ */
+
+#include "SummaryCollector.hpp"
+
+#include <iostream>
+#include <list>
+#include <sstream>
+#include <vector>
+
+#include "../communication/Message.hpp"
+#include "../output/ResultSink.hpp"
+#include "../serialization/Serialization.hpp"
+
+using namespace std;
+
+SummaryCollector::SummaryCollector(int tag, int rank, int worldSize) :
+		Vertex(tag, rank, worldSize) {
+
+	// Global stats
+	sum_latency = 0;
+	sum_counts = 0;
+	num_windows = 0;
+
+	pthread_mutex_init(&stats_mutex, NULL);
+
+	D(cout << "SUMMARYCOLLECTOR [" << tag << "] CREATED @ " << rank << endl;)
+}
+
+SummaryCollector::~SummaryCollector() {
+	pthread_mutex_destroy(&stats_mutex);
+	D(cout << "SUMMARYCOLLECTOR [" << tag << "] DELETED @ " << rank << endl;)
+}
+
+void SummaryCollector::batchProcess() {
+	D(cout << "SUMMARYCOLLECTOR->BATCHPROCESS [" << tag << "] @ " << rank << endl;)
+}
+
+void SummaryCollector::streamProcess(int channel) {
+
+	D(cout << "SUMMARYCOLLECTOR->STREAMPROCESS [" << tag << "] @ " << rank
+			<< " IN-CHANNEL " << channel << endl;)
+
+	if (rank != 0)
+		return;
+
+	Message* inMessage;
+	list<Message*> tmpMessages;
+
+	while (ALIVE) {
+
+		pthread_mutex_lock(&listenerMutexes[channel]);
+
+		while (inMessages[channel].empty())
+			pthread_cond_wait(&listenerCondVars[channel],
+					&listenerMutexes[channel]);
+
+		while (!inMessages[channel].empty()) {
+			inMessage = inMessages[channel].front();
+			inMessages[channel].pop_front();
+			tmpMessages.push_back(inMessage);
+		}
+
+		pthread_mutex_unlock(&listenerMutexes[channel]);
+
+		while (!tmpMessages.empty()) {
+
+			inMessage = tmpMessages.front();
+			tmpMessages.pop_front();
+
+			vector<WindowStats> summaries = Codec<WindowStats>::decode(inMessage, 0);
+
+			stringstream lines;
+
+			// the channels of the children share the global stats
+			pthread_mutex_lock(&stats_mutex);
+
+			for (const WindowStats& summary : summaries) {
+				sum_latency += summary.sum_latency;
+				sum_counts += summary.nof_results; // count of distinct c_id's processed
+				num_windows++;
+
+				lines << "\n  #" << num_windows << " WID: " << summary.WID
+						<< " COUNT: " << summary.count
+						<< "\tAVG_LATENCY: " << (sum_latency / sum_counts)
+						<< "\tMAX_LATENCY: " << summary.max_latency
+						<< "\tN=" << summary.nof_results << "\n\n";
+			}
+
+			pthread_mutex_unlock(&stats_mutex);
+
+			ResultSink::console().print(lines.str());
+
+			delete inMessage;
+		}
+	}
+}
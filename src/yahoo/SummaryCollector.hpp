@@ -0,0 +1,66 @@
+/**
+ * Copyright (c) 2020 University of Luxembourg. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY OF LUXEMBOURG AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE UNIVERSITY OF LUXEMBOURG OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+/*
+ * SummaryCollector.hpp
+ */
+
+#ifndef COLLECTOR_SUMMARYCOLLECTOR_HPP_
+#define COLLECTOR_SUMMARYCOLLECTOR_HPP_
+
+#include "../dataflow/Vertex.hpp"
+
+using namespace std;
+
+/**
+ * Root of the result collection in SINK_DISTRIBUTED mode : prints the
+ * WindowStats of every window on rank 0, while the results themselves
+ * stay on the ranks that produced them (see EventCollector).
+ */
+class SummaryCollector: public Vertex {
+
+public:
+
+	// Global stats
+	long int sum_latency;
+	long int sum_counts;
+	int num_windows;
+
+	SummaryCollector(int tag, int rank, int worldSize);
+
+	~SummaryCollector();
+
+	void batchProcess();
+
+	void streamProcess(int channel);
+
+private:
+
+	pthread_mutex_t stats_mutex;
+
+};
+
+#endif /* COLLECTOR_SUMMARYCOLLECTOR_HPP_ */
@@ -105,8 +105,7 @@ void EventFilterM::streamProcess(int channel) {
 			//	sede.printWrapper(&wrapper_unit);
 			//}
 
-			int offset = sizeof(int)
-					+ (inMessage->wrapper_length * sizeof(WrapperUnit));
+			int offset = MessageHeader::length(inMessage->wrapper_length);
 
 			outMessagesClickandView[0] = new Message(inMessage->size - offset,
 					inMessage->wrapper_length); // create new message with max. required capacity
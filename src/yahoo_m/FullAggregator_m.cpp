@@ -121,9 +121,10 @@ void FullAggregatorM::streamProcess(int channel) {
 			list<long int> completed_windows;
 
 			sede.unwrap(inMessage);
-			if (inMessage->wrapper_length > 0) {
+			// one wrapper unit per window the message spans
+			for (int u = 0; u < inMessage->wrapper_length; u++) {
 
-				sede.unwrapFirstWU(inMessage, &wrapper_unit);
+				sede.unwrapWU(inMessage, &wrapper_unit, u);
 //				sede.printWrapper(&wrapper_unit);
 
 				WID = wrapper_unit.window_start_time / AGG_WIND_SPAN;
@@ -133,48 +134,34 @@ void FullAggregatorM::streamProcess(int channel) {
 				} else {
 					pthread_mutex_lock(&WIDtoWrapperUnit_mutex); //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-					if ((WIDtoWrapperUnit_it = WIDtoWrapperUnit.find(WID))
-							!= WIDtoWrapperUnit.end()) {
+					// the first unit may already complete the window (e.g. pre-aggregated upstream)
+					WIDtoWrapperUnit_it = WIDtoWrapperUnit.emplace(WID,
+							make_pair(0,
+									wrapper_unit.completeness_tag_denominator)).first;
 
-						WIDtoWrapperUnit_it->second.first =
-								WIDtoWrapperUnit_it->second.first
-										+ wrapper_unit.completeness_tag_numerator;
+					WIDtoWrapperUnit_it->second.first =
+							WIDtoWrapperUnit_it->second.first
+									+ wrapper_unit.completeness_tag_numerator;
 
-						//cout << "____AGGREGATE WRAPPER: " << WID << " NUM="
-						//		<< WIDtoWrapperUnit_it->second.first << " DEN="
-						//		<< WIDtoWrapperUnit_it->second.second << endl;
-
-						if (WIDtoWrapperUnit_it->second.first
-								/ WIDtoWrapperUnit_it->second.second) {
-							completed_windows.push_back(WID);
-							WIDtoWrapperUnit.erase(WID);
-							//cout << "____WID COMPLETE: " << WID << endl;
-						}
-
-					} else {
-
-						WIDtoWrapperUnit.emplace(WID,
-								make_pair(
-										wrapper_unit.completeness_tag_numerator,
-										wrapper_unit.completeness_tag_denominator));
+					//cout << "____AGGREGATE WRAPPER: " << WID << " NUM="
+					//		<< WIDtoWrapperUnit_it->second.first << " DEN="
+					//		<< WIDtoWrapperUnit_it->second.second << endl;
 
+					if (WIDtoWrapperUnit_it->second.first
+							/ WIDtoWrapperUnit_it->second.second) {
+						completed_windows.push_back(WID);
+						WIDtoWrapperUnit.erase(WID);
+						//cout << "____WID COMPLETE: " << WID << endl;
 					}
 
 					pthread_mutex_unlock(&WIDtoWrapperUnit_mutex);//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
 				}
 			}
 
-			int offset = sizeof(int)
-					+ (inMessage->wrapper_length * sizeof(WrapperUnit));
-
-			int wrappers_per_msg =1;
-
-			outMessage = new Message(sizeof(EventPC_m)*100, wrappers_per_msg); // create new message with max. required capacity and just one wrappering-unit
+			int offset = MessageHeader::length(inMessage->wrapper_length);
 
 			int event_count = (inMessage->size - offset) / sizeof(EventPA);
 
-			memcpy(outMessage->buffer, &wrappers_per_msg, sizeof(int));
-
 			//cout << "EVENT_COUNT: " << event_count << endl;
 
 			pthread_mutex_lock(&WIDtoIHM_mutex); //===========================================================================
@@ -229,27 +216,39 @@ void FullAggregatorM::streamProcess(int channel) {
 			//cout << "\nFULLAGGR TIME_NOW:  " << time_now << endl;
 			//printf("FULLAGGR MPI_Wtime: %lf\n", (MPI_Wtime() * 1000.0));
 
+			/* one message per completed window, with a single wrapper unit: the
+			 * join completes the window once it has received the results of
+			 * both the click and the view aggregator (1/2 each) */
+			list<Message*> windowMessages;
 
-			/* some window information would go missing if the more than one window results are available
-			 * since outMessage buffer is reserved only for 100 c_ids of a window*/
 			while (!completed_windows.empty()) {
 //				cout<<"---------------------------------------list size: "<<completed_windows.size()<<endl;
 				WID = completed_windows.front();
 				completed_windows.pop_front();
 
 				WIDtoIHM_it = WIDtoIHM.find(WID);
+				size_t nof_campaigns =
+						WIDtoIHM_it != WIDtoIHM.end() ?
+								WIDtoIHM_it->second.size() : 0;
+
+				outMessage = new Message(sizeof(EventPC_m) * nof_campaigns, 1);
+
+				/*Setting flow-wrapping information begins*/
+				MessageHeader header;
+				header.nof_wrapper_units = 1;
+				MessageHeader::write(header, outMessage);
+
+				wrapper_unit.completeness_tag_numerator = 1;
+				wrapper_unit.completeness_tag_denominator = 2;
+				wrapper_unit.window_start_time = WID * AGG_WIND_SPAN;
+				MessageHeader::writeWrapperUnit(wrapper_unit, 0, outMessage);
+				outMessage->size += MessageHeader::length(outMessage->wrapper_length);
+				/*Setting flow-wrapping information ends*/
+
+				// the message is sent even without events, or the join would
+				// never receive the completeness of the window
 				if (WIDtoIHM_it != WIDtoIHM.end()) {
 
-					j = 0;
-
-					/*Setting flow-wrapping information begins*/
-					wrapper_unit.completeness_tag_numerator = 1;
-					wrapper_unit.completeness_tag_denominator = 2;
-					wrapper_unit.window_start_time = WID;
-					memcpy(outMessage->buffer + sizeof(int), &wrapper_unit, sizeof(WrapperUnit));
-					outMessage->size += sizeof(int)+ outMessage->wrapper_length	* sizeof(WrapperUnit);
-					/*Setting flow-wrapping information ends*/
-
 					/*for each finished window serilaize all the events
 					 * (corresponding to 100 c_ids) to outmessage!*/
 					for (CIDtoCountAndMaxEventTime_it =
@@ -262,54 +261,54 @@ void FullAggregatorM::streamProcess(int channel) {
 						eventPC.c_id = CIDtoCountAndMaxEventTime_it->first;
 						eventPC.count =
 								CIDtoCountAndMaxEventTime_it->second.first;
-//						eventPC.latency = (time_now - eventPA.max_event_time);
-						eventPC.event_time = eventPA.max_event_time;
+						eventPC.event_time =
+								CIDtoCountAndMaxEventTime_it->second.second;
 						eventPC.type = this->event_type;
 
 //						sede.YSBprintPC_m(&eventPC);
 
 						sede.YSBserializePC_m(&eventPC, outMessage);
-
-						j++;
 					}
 
-					WIDtoIHM_it->second.clear(); // clear inner map
 					WIDtoIHM.erase(WID); // remove from outer map
 				}
+
+				windowMessages.push_back(outMessage);
 			}
 
 			pthread_mutex_unlock(&WIDtoIHM_mutex); //====================================================================
 
-			// Finally send message to a single collector on rank 0
-			int n = 0;
-			for (vector<Vertex*>::iterator v = next.begin(); v != next.end();
-					++v) {
+			// Finally send the results of each window to the join of the window
+			while (!windowMessages.empty()) {
+
+				outMessage = windowMessages.front();
+				windowMessages.pop_front();
+
+				WID = MessageHeader::readWrapperUnit(outMessage, 0).window_start_time
+						/ AGG_WIND_SPAN;
+
+				int n = 0;
+				for (vector<Vertex*>::iterator v = next.begin(); v != next.end();
+						++v) {
+
+					int idx = n * worldSize + WID % worldSize; // co-partitioned with the join
 
-				if (outMessage->size > 0) {
-//					sending simply to the first channel -- sharding is not performed here,
-//					since one message would contain multiple window aggregation results!
-					int idx = 0 + WID % worldSize; // "0" indicates the first succeeding operator
-cout<<"sending out data by rank-"<<rank<<" operator to channel-"<<idx<<endl;
 					// Normal mode: synchronize on outgoing message channel & send message
 					pthread_mutex_lock(&senderMutexes[idx]);
 					outMessages[idx].push_back(outMessage);
 
-					cout << "FULLAGGREGATOR->PUSHBACK MESSAGE [" << tag << "] #"
+					D(cout << "FULLAGGREGATOR->PUSHBACK MESSAGE [" << tag << "] #"
 							<< c << " @ " << rank << " IN-CHANNEL " << channel
 							<< " OUT-CHANNEL " << idx << " SIZE "
 							<< outMessage->size << " CAP "
-							<< outMessage->capacity << endl;
+							<< outMessage->capacity << endl;);
 
 					pthread_cond_signal(&senderCondVars[idx]);
 					pthread_mutex_unlock(&senderMutexes[idx]);
 
-				} else {
-
-					delete outMessage;
+					n++;
+					break; // only one successor node allowed!
 				}
-
-				n++;
-				break; // only one successor node allowed!
 			}
 
 			delete inMessage;
@@ -34,9 +34,11 @@
 #include "WinJoinYSB_m.hpp"
 
 #include <mpi.h>
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <list>
+#include <sstream>
 #include <unistd.h>
 
 #include "../communication/Message.hpp"
@@ -46,51 +48,68 @@
 using namespace std;
 
 WinJoinYSBM::WinJoinYSBM(int tag, int rank, int worldSize) :
-		Vertex(tag, rank, worldSize) {
+		Vertex(tag, rank, worldSize), sum_latency(0), sum_counts(0), num_windows(
+				0) {
 	D(cout << "WINJOINYSBM [" << tag << "] CREATED @ " << rank << endl;);
-	pthread_mutex_init(&WIDtoIHM_mutex, NULL);
-	pthread_mutex_init(&WIDtoWrapperUnit_mutex, NULL);
+	pthread_mutex_init(&table_mutex, NULL);
+
+	results = ResultSink::open<EventCTR>("Data/ctr" + to_string(rank) + ".csv");
 }
 
 WinJoinYSBM::~WinJoinYSBM() {
 	D(cout << "WINJOINYSBM [" << tag << "] DELETED @ " << rank << endl;);
+	delete results;
+	pthread_mutex_destroy(&table_mutex);
 }
 
 void WinJoinYSBM::batchProcess() {
 	D(cout << "WINJOINYSBM->BATCHPROCESS [" << tag << "] @ " << rank << endl;);
 }
 
+/**
+ * Removes the campaigns of a completed window from the table and computes
+ * their click-through rate (called with table_mutex held).
+ */
+void WinJoinYSBM::join(long int WID, vector<EventCTR>& ctrs) {
+
+	long int time_now = (long int) (MPI_Wtime() * 1000.0);
+
+	WIDandCIDtoCounts.extract(WID,
+			[&](long int c_id, const ClickViewCounts& counts) {
+				EventCTR ctr;
+				ctr.WID = WID;
+				ctr.c_id = c_id;
+				ctr.clicks = counts.clicks;
+				ctr.views = counts.views;
+				ctr.ctr = counts.views > 0 ? (double) counts.clicks / counts.views : 0.0;
+				ctr.latency = time_now - counts.max_event_time;
+				ctrs.push_back(ctr);
+			});
+}
+
 void WinJoinYSBM::streamProcess(int channel) {
 	D(cout << "WINJOINYSBM->STREAMPROCESS [" << tag << "] @ " << rank
 			<< " IN-CHANNEL " << channel << endl;);
 
-	Message* inMessage, *outMessage;
+	Message* inMessage;
 	list<Message*>* tmpMessages = new list<Message*>();
 	Serialization sede;
 
 	WIDtoWrapperUnitHMap::iterator WIDtoWrapperUnit_it;
-	OuterHMapM::iterator WIDtoIHM_it;
-	InnerHMapM::iterator CIDtoCountAndMaxEventTime_it;
 
 	WrapperUnit wrapper_unit;
-	EventPA eventPA;
-	EventPC eventPC;
+	EventPC_m eventPC;
+
+	vector<EventCTR> ctrs;
 
-	int c = 0;
 	while (ALIVE) {
-//		sleep(10);
-		cout<<"__________________________________"<<rank<<endl;
-		int flag = 0;
+
 		pthread_mutex_lock(&listenerMutexes[channel]);
 
 		while (inMessages[channel].empty())
 			pthread_cond_wait(&listenerCondVars[channel],
 					&listenerMutexes[channel]);
 
-//		if (inMessages[channel].size() > 1){flag =1;
-//			cout << tag << " CHANNEL-" << channel << " BUFFER SIZE:"
-//					<< inMessages[channel].size() << endl;}
-
 		while (!inMessages[channel].empty()) {
 			inMessage = inMessages[channel].front();
 			inMessages[channel].pop_front();
@@ -99,200 +118,107 @@ void WinJoinYSBM::streamProcess(int channel) {
 
 		pthread_mutex_unlock(&listenerMutexes[channel]);
 
-//		if(flag==1)
-//		cout<<"CHANNEL-"<<channel<<" BUFFER SIZE:"<<tmpMessages->size()<<endl;
-
 		while (!tmpMessages->empty()) {
 
 			inMessage = tmpMessages->front();
 			tmpMessages->pop_front();
 
-			cout << "WINJOINYSBM->POP MESSAGE: TAG [" << tag << "] @ "
+			D(cout << "WINJOINYSBM->POP MESSAGE: TAG [" << tag << "] @ "
 					<< rank << " CHANNEL " << channel << " BUFFER "
-					<< inMessage->size << endl;
+					<< inMessage->size << endl;);
 
-			long int WID;
 			list<long int> completed_windows;
 
 			sede.unwrap(inMessage);
-			if (inMessage->wrapper_length > 0) {
-
-				sede.unwrapFirstWU(inMessage, &wrapper_unit);
-				sede.printWrapper(&wrapper_unit);
-
-//				WID = wrapper_unit.window_start_time / AGG_WIND_SPAN;
-//
-//				if (wrapper_unit.completeness_tag_denominator == 1) {
-//					completed_windows.push_back(WID);
-//				} else {
-//					pthread_mutex_lock(&WIDtoWrapperUnit_mutex); //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-//
-//					if ((WIDtoWrapperUnit_it = WIDtoWrapperUnit.find(WID))
-//							!= WIDtoWrapperUnit.end()) {
-//
-//						WIDtoWrapperUnit_it->second.first =
-//								WIDtoWrapperUnit_it->second.first
-//										+ wrapper_unit.completeness_tag_numerator;
-//
-//						//cout << "____AGGREGATE WRAPPER: " << WID << " NUM="
-//						//		<< WIDtoWrapperUnit_it->second.first << " DEN="
-//						//		<< WIDtoWrapperUnit_it->second.second << endl;
-//
-//						if (WIDtoWrapperUnit_it->second.first
-//								/ WIDtoWrapperUnit_it->second.second) {
-//							completed_windows.push_back(WID);
-//							WIDtoWrapperUnit.erase(WID);
-//							//cout << "____WID COMPLETE: " << WID << endl;
-//						}
-//
-//					} else {
-//
-//						WIDtoWrapperUnit.emplace(WID,
-//								make_pair(
-//										wrapper_unit.completeness_tag_numerator,
-//										wrapper_unit.completeness_tag_denominator));
-//
-//					}
-//
-//					pthread_mutex_unlock(&WIDtoWrapperUnit_mutex);//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
-//				}
+
+			int offset = MessageHeader::length(inMessage->wrapper_length);
+			int event_count = (inMessage->size - offset) / sizeof(EventPC_m);
+
+			pthread_mutex_lock(&table_mutex); //===========================================================================
+
+			// counts are added before the units, so that a window is
+			// never fired while some of its counts are still missing
+			for (int i = 0; i < event_count; i++) {
+
+				sede.YSBdeserializePC_m(inMessage, &eventPC,
+						offset + (i * sizeof(EventPC_m)));
+
+				ClickViewCounts& counts = WIDandCIDtoCounts.get(eventPC.WID,
+						eventPC.c_id);
+
+				if (eventPC.type == 1)
+					counts.clicks += eventPC.count;
+				else
+					counts.views += eventPC.count;
+
+				counts.max_event_time = max(counts.max_event_time,
+						eventPC.event_time);
 			}
-//
-//			int offset = sizeof(int)
-//					+ (inMessage->wrapper_length * sizeof(WrapperUnit));
-//
-//			outMessage = new Message(sizeof(EventPC) * 100); // create new message with max. required capacity
-//
-//			int event_count = (inMessage->size - offset) / sizeof(EventPA);
-//			//cout << "EVENT_COUNT: " << event_count << endl;
-//
-//			pthread_mutex_lock(&WIDtoIHM_mutex); //===========================================================================
-//
-//			int i = 0, j = 0, k = 0;
-//			while (i < event_count) {
-//
-//				sede.YSBdeserializePA(inMessage, &eventPA,
-//						offset + (i * sizeof(EventPA)));
-//
-//				WID = eventPA.max_event_time / AGG_WIND_SPAN;
-//
-//				if ((WIDtoIHM_it = WIDtoIHM.find(WID)) != WIDtoIHM.end()) {
-//
-//					if ((CIDtoCountAndMaxEventTime_it =
-//							WIDtoIHM_it->second.find(eventPA.c_id))
-//							!= WIDtoIHM_it->second.end()) {
-//
-//						CIDtoCountAndMaxEventTime_it->second.first =
-//								CIDtoCountAndMaxEventTime_it->second.first
-//										+ eventPA.count;
-//
-//						if (CIDtoCountAndMaxEventTime_it->second.second
-//								< eventPA.max_event_time) { // new max. event time!
-//							CIDtoCountAndMaxEventTime_it->second.second =
-//									eventPA.max_event_time;
-//						}
-//
-//					} else { // new entry in inner hashmap!
-//
-//						WIDtoIHM_it->second.emplace(eventPA.c_id,
-//								std::make_pair(eventPA.count,
-//										eventPA.max_event_time));
-//						k++;
-//					}
-//
-//				} else { // new entry in outer hashmap!
-//
-//					InnerHMap new_CIDtoCountAndMaxEventTime(100);
-//					new_CIDtoCountAndMaxEventTime.emplace(eventPA.c_id,
-//							std::make_pair(eventPA.count,
-//									eventPA.max_event_time));
-//					WIDtoIHM.emplace(WID, new_CIDtoCountAndMaxEventTime);
-//
-//					j++;
-//				}
-//
-//				i++;
-//			}
-//
-//			long int time_now = (long int) (MPI_Wtime() * 1000.0);
-//			//cout << "\nFULLAGGR TIME_NOW:  " << time_now << endl;
-//			//printf("FULLAGGR MPI_Wtime: %lf\n", (MPI_Wtime() * 1000.0));
-//
-//			while (!completed_windows.empty()) {
-//
-//				WID = completed_windows.front();
-//				completed_windows.pop_front();
-//
-//				WIDtoIHM_it = WIDtoIHM.find(WID);
-//				if (WIDtoIHM_it != WIDtoIHM.end()) {
-//
-//					j = 0;
-//					for (CIDtoCountAndMaxEventTime_it =
-//							WIDtoIHM_it->second.begin();
-//							CIDtoCountAndMaxEventTime_it
-//									!= WIDtoIHM_it->second.end();
-//							CIDtoCountAndMaxEventTime_it++) {
-//
-//						eventPC.WID = WID;
-//						eventPC.c_id = CIDtoCountAndMaxEventTime_it->first;
-//						eventPC.count =
-//								CIDtoCountAndMaxEventTime_it->second.first;
-//						eventPC.latency = (time_now - eventPA.max_event_time);
-//
-//						cout << "  " << j << "\tWID: " << eventPC.WID
-//								<< "\tc_id: " << eventPC.c_id << "\tcount: "
-//								<< eventPC.count << "\tlatency: "
-//								<< eventPC.latency << " SIZE "
-//								<< outMessage->size << " CAP "
-//								<< outMessage->capacity << endl;
-//
-//						sede.YSBserializePC(&eventPC, outMessage);
-//						//sede.YSBdeserializePC(outMessage, &eventPC,
-//						//		outMessage->size - sizeof(EventPC));
-//						//sede.YSBprintPC(&eventPC);
-//						j++;
-//					}
-//
-//					WIDtoIHM_it->second.clear(); // clear inner map
-//					WIDtoIHM.erase(WID); // remove from outer map
-//				}
-//			}
-//
-//			pthread_mutex_unlock(&WIDtoIHM_mutex); //====================================================================
-//
-//			// Finally send message to a single collector on rank 0
-//			int n = 0;
-//			for (vector<Vertex*>::iterator v = next.begin(); v != next.end();
-//					++v) {
-//
-//				if (outMessage->size > 0) {
-//
-//					int idx = n * worldSize + 0; // send to rank 0 only
-//
-//					// Normal mode: synchronize on outgoing message channel & send message
-//					pthread_mutex_lock(&senderMutexes[idx]);
-//					outMessages[idx].push_back(outMessage);
-//
-//					D(cout << "FULLAGGREGATOR->PUSHBACK MESSAGE [" << tag << "] #"
-//							<< c << " @ " << rank << " IN-CHANNEL " << channel
-//							<< " OUT-CHANNEL " << idx << " SIZE "
-//							<< outMessage->size << " CAP "
-//							<< outMessage->capacity << endl;);
-//
-//					pthread_cond_signal(&senderCondVars[idx]);
-//					pthread_mutex_unlock(&senderMutexes[idx]);
-//
-//				} else {
-//
-//					delete outMessage;
-//				}
-//
-//				n++;
-//				break; // only one successor node allowed!
-//			}
-//
-//			delete inMessage;
-//			c++;
+
+			// one wrapper unit per window the message spans
+			for (int u = 0; u < inMessage->wrapper_length; u++) {
+
+				sede.unwrapWU(inMessage, &wrapper_unit, u);
+
+				long int WID = wrapper_unit.window_start_time / AGG_WIND_SPAN;
+
+				if ((WIDtoWrapperUnit_it = WIDtoWrapperUnit.find(WID))
+						!= WIDtoWrapperUnit.end()) {
+
+					WIDtoWrapperUnit_it->second.first +=
+							wrapper_unit.completeness_tag_numerator;
+
+					if (WIDtoWrapperUnit_it->second.first
+							/ WIDtoWrapperUnit_it->second.second) {
+						completed_windows.push_back(WID);
+						WIDtoWrapperUnit.erase(WIDtoWrapperUnit_it);
+					}
+
+				} else if (wrapper_unit.completeness_tag_numerator
+						/ wrapper_unit.completeness_tag_denominator) {
+
+					completed_windows.push_back(WID);
+
+				} else {
+
+					WIDtoWrapperUnit.emplace(WID,
+							make_pair(wrapper_unit.completeness_tag_numerator,
+									wrapper_unit.completeness_tag_denominator));
+				}
+			}
+
+			for (long int WID : completed_windows) {
+
+				ctrs.clear();
+				join(WID, ctrs);
+
+				int clicks = 0, views = 0;
+				long int latency = 0;
+				for (const EventCTR& ctr : ctrs) {
+					clicks += ctr.clicks;
+					views += ctr.views;
+					latency = max(latency, ctr.latency);
+				}
+
+				num_windows++;
+				sum_counts += clicks + views;
+				sum_latency += latency;
+
+				results->write(ctrs);
+
+				stringstream line;
+				line << "  " << num_windows << "\tWID: " << WID
+						<< "\tCLICKS: " << clicks << "\tVIEWS: " << views
+						<< "\tCTR: "
+						<< (views > 0 ? (double) clicks / views : 0.0)
+						<< "\tLATENCY: " << latency << "\tN: " << ctrs.size()
+						<< "\n";
+				ResultSink::console().print(line.str());
+			}
+
+			pthread_mutex_unlock(&table_mutex); //====================================================================
+
+			delete inMessage;
 		}
 
 		tmpMessages->clear();
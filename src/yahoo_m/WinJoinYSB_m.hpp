@@ -36,27 +36,145 @@
 
 #include <unordered_map>
 #include <utility>
+#include <vector>
+#include <climits>
 
 #include "../dataflow/Vertex.hpp"
+#include "../output/ResultSink.hpp"
 
 using namespace std;
 
-typedef std::pair<int, int> counts_click_view_pair;
-typedef std::pair< counts_click_view_pair, long int > countpair_maxeventtime;
-typedef unordered_map<long int, countpair_maxeventtime> InnerHMapM;
-typedef unordered_map<long int, InnerHMapM > OuterHMapM;
+// clicks and views of a campaign in a window
+typedef struct ClickViewCounts {
+	int clicks = 0;
+	int views = 0;
+	long int max_event_time = 0;
+} ClickViewCounts;
+
+/**
+ * Flat table of the (window, campaign) pairs, shared by the click and the
+ * view stream: both streams update the same entry, so the CTR of a campaign
+ * is available as soon as the window completes.
+ *
+ * Open addressing with linear probing, the entries of a completed window
+ * are replaced by tombstones (reused by the next insertions, and dropped
+ * when the table is rehashed).
+ */
+class ClickViewTable {
+
+public:
+
+	ClickViewTable(size_t capacity = 256); // power of 2
+
+	ClickViewCounts& get(long int WID, long int c_id);
+
+	// calls f(c_id, counts) for every campaign of the window, then removes them
+	template<typename F>
+	void extract(long int WID, F f);
+
+	size_t size() const;
+
+private:
+
+	static const long int NO_WINDOW = LONG_MIN;
+	static const long int ERASED = LONG_MIN + 1;
+
+	vector<long int> WIDs;
+	vector<long int> c_ids;
+	vector<ClickViewCounts> counts;
+	size_t nof_keys;
+	size_t nof_erased;
+
+	size_t slot(long int WID, long int c_id) const;
+
+	void rehash(size_t capacity);
+};
+
+inline ClickViewTable::ClickViewTable(size_t capacity) :
+		WIDs(capacity, (long int) NO_WINDOW), c_ids(capacity), counts(capacity), nof_keys(
+				0), nof_erased(0) {
+}
+
+inline size_t ClickViewTable::slot(long int WID, long int c_id) const {
+	size_t h = (size_t) c_id * 0x9E3779B97F4A7C15ULL
+			^ (size_t) WID * 0xC2B2AE3D27D4EB4FULL;
+	return (h ^ (h >> 29)) & (WIDs.size() - 1);
+}
+
+inline ClickViewCounts& ClickViewTable::get(long int WID, long int c_id) {
+
+	if ((nof_keys + nof_erased + 1) * 2 > WIDs.size())
+		rehash(nof_keys * 4 > WIDs.size() ? WIDs.size() * 2 : WIDs.size());
+
+	size_t i = slot(WID, c_id);
+	size_t free = WIDs.size(); // first tombstone on the way
+
+	while (WIDs[i] != NO_WINDOW) {
+		if (WIDs[i] == WID && c_ids[i] == c_id)
+			return counts[i];
+		if (WIDs[i] == ERASED && free == WIDs.size())
+			free = i;
+		i = (i + 1) & (WIDs.size() - 1);
+	}
+
+	if (free != WIDs.size()) {
+		i = free;
+		nof_erased--;
+	}
+
+	WIDs[i] = WID;
+	c_ids[i] = c_id;
+	counts[i] = ClickViewCounts();
+	nof_keys++;
+	return counts[i];
+}
+
+template<typename F>
+void ClickViewTable::extract(long int WID, F f) {
+	for (size_t i = 0; i < WIDs.size(); i++) {
+		if (WIDs[i] == WID) {
+			f(c_ids[i], counts[i]);
+			WIDs[i] = ERASED;
+			nof_keys--;
+			nof_erased++;
+		}
+	}
+}
+
+inline size_t ClickViewTable::size() const {
+	return nof_keys;
+}
+
+inline void ClickViewTable::rehash(size_t capacity) {
+	ClickViewTable rehashed(capacity);
+	for (size_t i = 0; i < WIDs.size(); i++) {
+		if (WIDs[i] != NO_WINDOW && WIDs[i] != ERASED)
+			rehashed.get(WIDs[i], c_ids[i]) = counts[i];
+	}
+	*this = std::move(rehashed);
+}
 
 typedef unordered_map<long int, std::pair<int, int>> WIDtoWrapperUnitHMap;
 
+/**
+ * Windowed join of the click and view counts of the YSB* full aggregators
+ * (co-partitioned by window), computing the click-through rate of every
+ * campaign once both streams have completed the window.
+ */
 class WinJoinYSBM: public Vertex {
 
 public:
 
-	OuterHMapM WIDtoIHM;
-	pthread_mutex_t WIDtoIHM_mutex;
+	ClickViewTable WIDandCIDtoCounts;
 
 	WIDtoWrapperUnitHMap WIDtoWrapperUnit;
-	pthread_mutex_t WIDtoWrapperUnit_mutex;
+
+	pthread_mutex_t table_mutex; // both tables, only the two streams of a window contend
+
+	// Global stats
+	long int sum_latency;
+	long int sum_counts;
+	int num_windows;
 
 	WinJoinYSBM(int tag, int rank, int worldSize);
 
@@ -66,6 +184,12 @@ public:
 
 	void streamProcess(int channel);
 
+private:
+
+	ResultSink* results;
+
+	void join(long int WID, vector<EventCTR>& ctrs);
+
 };
 
 #endif /* OPERATOR_WINJOINYSBM_HPP_ */